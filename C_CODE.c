@@ -12,47 +12,174 @@
     8. VIEW ONLY ACTIVE STUDENTS
     9. VIEW ONLY OPEN ISSUES
     10. EXPORT ALL STUDENTS TO A TEXT REPORT FILE (students_report.txt)
+    11. ROOM INVENTORY WITH BED OCCUPANCY BITMAPS (NO OVERBOOKING)
+    12. BULK ROOM ALLOCATION FOR UNASSIGNED STUDENTS BY BLOCK PREFERENCE
+    13. TIME-STAMPED ISSUE LIFECYCLE WITH A TRANSITION LOG (ticket_log.dat)
+    14. ISSUE SLA METRICS (OPEN AGE, MEAN / P95 RESOLUTION PER BLOCK) + JSON EXPORT
+    15. COPY-ON-WRITE SNAPSHOTS WITH POINT-IN-TIME RESTORE AND SNAPSHOT DIFF
+    16. COMPRESSED ARCHIVE (archive.dat) FOR INACTIVE STUDENTS AND OLD RESOLVED ISSUES
+    17. BACKGROUND SAVING THREAD (MENUS NEVER WAIT FOR THE DISK)
+    18. RECORDS STORED IN ONE SET OF FILES PER HOSTEL BLOCK (SHARDS), LOADED IN PARALLEL
+    19. SAVED ID / NAME / ISSUE-OWNER INDEXES, SO STARTUP DOES NOT REBUILD THEM
+    20. GATE ENTRY / EXIT LOG: APPEND-ONLY DAY SEGMENTS, WHO IS OUTSIDE, CURFEW REPORT
+    21. STUDENT IMPORT / EXPORT AS CSV OR JSON LINES, DRIVEN BY ONE FIELD TABLE
 */
 
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L             /* clock_gettime() AND PTHREADS UNDER -std=c99 */
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <dirent.h>
+#endif
 
+#ifndef MAX_STUDENTS                        /* THE BENCHMARK BUILD RAISES BOTH LIMITS */
 #define MAX_STUDENTS 200
+#endif
+#ifndef MAX_TICKETS
 #define MAX_TICKETS 500
+#endif
 
 #define STUDENT_FILE "students.dat"
 #define TICKET_FILE  "tickets.dat"
 #define REPORT_FILE  "students_report.txt"
+#define ROOM_FILE    "rooms.dat"
+#define TICKET_LOG_FILE "ticket_log.dat"
+#define SLA_JSON_FILE   "sla_report.json"
+#define ARCHIVE_FILE    "archive.dat"
+#define SHARD_FILE      "shards.dat"        /* SHARD LIST AND RECORD COUNTS */
+#define SHARD_STUDENT_FILE "shard_%.9s_students.dat"   /* %.9s = SHARD KEY */
+#define SHARD_TICKET_FILE  "shard_%.9s_tickets.dat"
+#define INDEX_FILE      "indexes.dat"
+#define GATE_FILE       "gate_%04d%02d%02d.dat"     /* ONE APPEND-ONLY SEGMENT FILE PER DAY (UTC) */
+#define GATE_OUTSIDE_FILE "gate_outside.dat"
+#define GATE_IMPORT_FILE  "gate_events.csv"
+#define STUDENT_CSV_FILE  "students.csv"
+#define STUDENT_JSONL_FILE "students.jsonl"
+
+#define MAX_ROOMS 256
+#define MAX_BLOCKS 16
+#define MAX_BEDS_PER_ROOM 32                /* ONE BIT PER BED IN AN unsigned int */
+#define ROOM_WORDS (MAX_ROOMS / 32)         /* WORDS IN A PER-BLOCK ROOM BITMAP */
+
+#define TICKET_FILE_MAGIC 0x32544D48        /* "HMT2" - CANNOT BE A LEGACY TICKET COUNT */
+#define TICKET_FILE_VERSION 2
+
+#define TICKET_OPEN 0
+#define TICKET_IN_PROGRESS 1
+#define TICKET_RESOLVED 2
+#define TICKET_NONE -1                      /* "FROM" STATUS OF A NEWLY RAISED TICKET */
+
+#define SLA_BREACH_HOURS 72                 /* OPEN LONGER THAN THIS = SLA BREACH */
+#define SLA_DAY_SLOTS 32                    /* OPEN TICKETS COUNTED PER CREATION DAY */
+#define SLA_RES_BUCKETS 240                 /* LOG-LINEAR RESOLUTION TIME HISTOGRAM */
+#define SLA_OTHER_BLOCKS "OTHER"            /* REPORT ROW FOR BLOCKS PAST MAX_BLOCKS */
+#define SECONDS_PER_DAY 86400u
+
+#define PAGE_RECORDS 16                     /* RECORDS PER COPY-ON-WRITE PAGE */
+#define STUDENT_PAGES ((MAX_STUDENTS + PAGE_RECORDS - 1) / PAGE_RECORDS)
+#define TICKET_PAGES ((MAX_TICKETS + PAGE_RECORDS - 1) / PAGE_RECORDS)
+#define MAX_SNAPSHOTS 8                     /* OLDEST SNAPSHOT IS DROPPED BEYOND THIS */
+#define SNAPSHOT_INTERVAL 5                 /* AUTOMATIC SNAPSHOT AFTER THIS MANY ADMIN ACTIONS */
+
+#define ROOM_ADDED 0                        /* insert_room() RESULTS */
+#define ROOM_DUPLICATE 1
+#define ROOM_BLOCK_LIMIT 2
+#define ROOM_TOO_SMALL 3
+
+#define PERSIST_MAX_LAG_MS 1000            /* A CHANGE REACHES THE DISK WITHIN THIS (PLUS WRITE TIME) */
+#define PERSIST_COALESCE_MS 150             /* WAIT THIS LONG FOR MORE EDITS BEFORE WRITING */
+
+#define SHARD_MAGIC 0x31534D48              /* "HMS1" */
+#define SHARD_VERSION 2                     /* 2 ADDED THE GENERATION STAMP; 1 IS STILL READ */
+#define MAX_SHARDS 32                       /* FURTHER BLOCKS SHARE THE LAST SHARD'S FILES */
+#define SHARD_KEY_SIZE 10                   /* SAME AS hostel_block */
+
+#define INDEX_MAGIC 0x31584D48              /* "HMX1" */
+#define INDEX_VERSION 2                     /* 2 = NAME PIECES AND A CHECKSUM; 1 HAD WORD STARTS */
+#define INDEX_CHECKSUM_SEED 2166136261u     /* FNV-1a OFFSET BASIS */
+#define NAME_GRAM_BITS 16                   /* NAME SEARCH: 3-CHARACTER PIECES HASHED INTO 65536 BUCKETS */
+#define NAME_GRAM_BUCKETS (1 << NAME_GRAM_BITS)
+#define NAME_GRAM_TAIL 4096                 /* STUDENTS ADDED SINCE THE NAME INDEX WAS BUILT BEFORE IT IS REDONE */
+#define PARALLEL_REBUILD_MIN 50000          /* FEWER RECORDS THAN THIS: REBUILD ON ONE THREAD */
+
+#define GATE_MAGIC 0x31474D48               /* "HMG1", AT THE START OF EVERY SEGMENT */
+#define GATE_OUTSIDE_MAGIC 0x314F4D48       /* "HMO1" */
+#define GATE_BATCH_EVENTS 512               /* SCANS QUEUED, THEN WRITTEN AS ONE SEGMENT */
+#define GATE_OUT 0
+#define GATE_IN 1
+#define GATE_CURFEW_HOUR 22                 /* LOCAL TIME: CURFEW RUNS 22:00 - 06:00 */
+#define GATE_CURFEW_END_HOUR 6
+#define GATE_WEEK_DAYS 7
+#define GATE_REBUILD_DAYS 31                /* REPLAYED IF gate_outside.dat IS LOST */
+#define GATE_CLOCK_SLACK 300                /* SCANNER CLOCKS MAY RUN A LITTLE AHEAD */
+
+#define ARCHIVE_MAGIC 0x31414D48            /* "HMA1" */
+#define ARCHIVE_BLOCK_RECORDS 32            /* RECORDS COMPRESSED TOGETHER */
+#define ARCHIVE_AFTER_DAYS 30               /* RESOLVED ISSUES OLDER THAN THIS ARE ARCHIVED */
+#define ARCHIVE_STUDENTS 1
+#define ARCHIVE_TICKETS 2
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + 127)
+
+#define FIELD_BASIC 1                       /* STUDENT FIELD GROUPS, AS NUMBERED IN THE UPDATE MENU */
+#define FIELD_CONTACT 2
+#define FIELD_ACADEMIC 3
+#define FIELD_HOSTEL 4
+#define FIELD_PERSONAL 5
+#define FIELD_FEE 6
+#define FIELD_LOCATION 7
+#define FIELD_GROUPS 7
+#define IMPORT_CELL_SIZE 128                /* LONGER THAN ANY STUDENT FIELD */
+#define IMPORT_MAX_CELLS 64                 /* FURTHER COLUMNS OF AN IMPORTED ROW ARE IGNORED */
+#define EXPORT_LINE_SIZE (sizeof(Student) * 6 + 1024)   /* A BYTE IS AT MOST 6 WHEN ESCAPED (\u00XX) */
 
 #define ADMIN_PASSWORD "ADMIN123"
 
+/* EVERY STUDENT TEXT FIELD, ONE LINE EACH: MEMBER, SIZE, LABEL, PROMPT HINT, UPDATE GROUP.
+   THE STRUCT, THE ADD AND UPDATE PROMPTS, THE REPORT AND THE CSV / JSONL IMPORT AND EXPORT
+   ARE ALL GENERATED FROM THIS LIST, SO A NEW FIELD IS ONE MORE LINE HERE (NOTE THAT IT
+   CHANGES THE RECORD SIZE OF THE DATA FILES). THE MEMBER NAME IS ALSO THE COLUMN NAME. */
+#define STUDENT_FIELDS(X) \
+    X(name,            50, "STUDENT NAME",         "",                     FIELD_BASIC)    \
+    X(parent_name,     50, "FATHER / PARENT NAME", "",                     FIELD_BASIC)    \
+    X(mother_name,     50, "MOTHER NAME",          "",                     FIELD_BASIC)    \
+    X(phone,           20, "PHONE NUMBER",         "",                     FIELD_CONTACT)  \
+    X(email,           50, "EMAIL ID",             "",                     FIELD_CONTACT)  \
+    X(room_no,         10, "ROOM NUMBER",          "",                     FIELD_HOSTEL)   \
+    X(blood_group,      5, "BLOOD GROUP",          "",                     FIELD_PERSONAL) \
+    X(year,            10, "YEAR",                 " (I / II / III / IV)", FIELD_ACADEMIC) \
+    X(department,      30, "DEPARTMENT",           "",                     FIELD_ACADEMIC) \
+    X(campus,           5, "CAMPUS",               " (A / B)",             FIELD_ACADEMIC) \
+    X(district,        30, "DISTRICT",             "",                     FIELD_LOCATION) \
+    X(state,           30, "STATE",                "",                     FIELD_LOCATION) \
+    X(pincode,         10, "PINCODE",              "",                     FIELD_LOCATION) \
+    X(address,        100, "FULL ADDRESS",         "",                     FIELD_CONTACT)  \
+    X(guardian_name,   50, "GUARDIAN NAME",        "",                     FIELD_CONTACT)  \
+    X(guardian_phone,  20, "GUARDIAN PHONE",       "",                     FIELD_CONTACT)  \
+    X(dob,             15, "DATE OF BIRTH",        " (DD/MM/YYYY)",        FIELD_PERSONAL) \
+    X(gender,          10, "GENDER",               "",                     FIELD_PERSONAL) \
+    X(hostel_block,    10, "HOSTEL BLOCK",         "",                     FIELD_HOSTEL)   \
+    X(admission_year,  10, "ADMISSION YEAR",       "",                     FIELD_ACADEMIC) \
+    X(fee_status,      20, "FEE STATUS",           " (PAID / NOT_PAID)",   FIELD_FEE)
+
+#define STUDENT_MEMBER(field, size, label, hint, group) char field[size];
+
 typedef struct {
     int id;                         // STUDENT / ROLL ID (UNIQUE)
-    char name[50];
-    char parent_name[50];
-    char mother_name[50];
-    char phone[20];
-    char email[50];
-    char room_no[10];
-    char blood_group[5];
-    char year[10];
-    char department[30];
-    char campus[5];                 // CAMPUS A / B
-    char district[30];
-
-    /* +10 EXTRA BASIC DETAILS */
-    char state[30];
-    char pincode[10];
-    char address[100];
-    char guardian_name[50];
-    char guardian_phone[20];
-    char dob[15];                   // DD/MM/YYYY
-    char gender[10];
-    char hostel_block[10];
-    char admission_year[10];
-    char fee_status[20];           // "PAID" / "NOT_PAID"
-
+    STUDENT_FIELDS(STUDENT_MEMBER)
     int is_active;                  // 1 = ACTIVE, 0 = DELETED
 } Student;
 
@@ -62,8 +189,284 @@ typedef struct {
     char student_name[50];          // COPY FOR EASY VIEW
     char issue[200];
     char status[20];                // "OPEN", "IN_PROGRESS", "RESOLVED"
+    char hostel_block[10];          // COPY OF STUDENT BLOCK WHEN RAISED
+
+    /* UNIX TIMES IN SECONDS, 0 = NOT REACHED (OR UNKNOWN FOR MIGRATED TICKETS) */
+    unsigned int created_at;
+    unsigned int in_progress_at;
+    unsigned int resolved_at;
 } Ticket;
 
+/* LAYOUT OF tickets.dat BEFORE TIMESTAMPS, STILL READ ON FIRST START */
+typedef struct {
+    int ticket_id;
+    int student_id;
+    char student_name[50];
+    char issue[200];
+    char status[20];
+} TicketV1;
+
+typedef struct {
+    int magic;
+    int version;
+    int count;
+    int next_ticket_id;
+} TicketFileHeader;
+
+/* ONE RECORD PER STATUS CHANGE, APPENDED TO ticket_log.dat */
+typedef struct {
+    int ticket_id;
+    unsigned int at;
+    signed char from_status;        // TICKET_NONE / TICKET_OPEN / ...
+    signed char to_status;
+} TicketTransition;
+
+/* IMMUTABLE COPY OF PAGE_RECORDS CONSECUTIVE RECORDS, SHARED BY EVERY SNAPSHOT
+   IN WHICH THOSE RECORDS DID NOT CHANGE */
+typedef struct {
+    int refs;
+    int records;                        // USED RECORDS (LAST PAGE MAY BE PARTIAL)
+    unsigned char data[];
+} SnapshotPage;
+
+typedef struct {
+    int id;
+    unsigned int taken_at;
+    int student_count;
+    int ticket_count;
+    int next_ticket_id;
+    int new_pages;                      // PAGES COPIED WHEN TAKEN (THE REST ARE SHARED)
+    int student_page_count;
+    int ticket_page_count;
+    SnapshotPage **student_pages;
+    SnapshotPage **ticket_pages;
+} Snapshot;
+
+/* archive.dat = HEADER, COMPRESSED BLOCKS, THEN THE BLOCK INDEX AT index_offset */
+typedef struct {
+    int magic;
+    int block_count;
+    unsigned int index_offset;
+    int student_records;
+    int ticket_records;
+} ArchiveHeader;
+
+typedef struct {
+    int kind;                           // ARCHIVE_STUDENTS / ARCHIVE_TICKETS
+    int min_id;
+    int max_id;
+    int records;
+    unsigned int offset;
+    unsigned int packed_size;
+} ArchiveBlock;
+
+/* TEXT FIELD POSITION, USED TO ZERO THE BYTES AFTER THE TERMINATOR */
+typedef struct {
+    size_t offset;
+    size_t size;
+} TextField;
+
+/* ONE LINE OF STUDENT_FIELDS, KEPT AS DATA SO THAT LOOPS CAN WALK THE FIELDS */
+typedef struct {
+    const char *key;                    // MEMBER NAME, ALSO THE CSV / JSONL COLUMN NAME
+    const char *label;
+    const char *hint;                   // SHOWN AFTER THE LABEL IN PROMPTS
+    size_t offset;
+    size_t size;
+    int group;                          // FIELD_BASIC ... FIELD_LOCATION
+} StudentField;
+
+/* OUTCOME OF A STUDENT IMPORT */
+typedef struct {
+    int added;
+    int added_without_room;             // ALSO COUNTED IN added
+    int updated;
+    int unchanged;
+    int refused;
+    int bad;                            // ROWS NOT UNDERSTOOD
+    int report;                         // PRINT THE FIRST FEW PROBLEMS
+} ImportTally;
+
+/* SLA AGGREGATES FOR ONE BLOCK, UPDATED ON EVERY TRANSITION */
+typedef struct {
+    char name[10];
+    int open;
+    int resolved;
+    int resolved_late;                  // RESOLVED AFTER SLA_BREACH_HOURS
+    long long total_resolve_secs;
+    int resolve_hist[SLA_RES_BUCKETS];
+} SlaBlockStats;
+
+typedef struct {
+    char hostel_block[10];
+    char room_no[10];
+    int capacity;                   // NUMBER OF BEDS (1 - 32)
+} Room;
+
+/* PER-BLOCK VIEW OF THE INVENTORY, REBUILT FROM rooms[] ON LOAD */
+typedef struct {
+    char name[10];
+    unsigned int vacancy[ROOM_WORDS];   // BIT r SET = rooms[r] HAS A FREE BED
+    int room_total;
+    int free_beds;
+} BlockInventory;
+
+/* WHAT THE WRITER THREAD SAVES: AN IMMUTABLE GENERATION OF THE STUDENT AND TICKET
+   PAGES PLUS A COPY OF THE (SMALL) ROOM TABLE */
+typedef struct PersistJob {
+    Snapshot generation;
+    Room rooms[MAX_ROOMS];
+    int room_count;
+    char dirty_shards[MAX_SHARDS][SHARD_KEY_SIZE];  // SHARDS WHOSE RECORDS CHANGED
+    int dirty_shard_count;
+    int all_shards_dirty;
+    struct PersistJob *next;            // WRITTEN JOBS WAITING TO BE FREED
+} PersistJob;
+
+/* shards.dat = HEADER, THEN shard_count KEYS. EACH SHARD FILE ENDS WITH THE ARRAY
+   POSITIONS OF ITS OWN RECORDS, SO LOADING PUTS THE RECORDS BACK IN THE SAME ORDER AND
+   shards.dat STAYS SMALL HOWEVER MANY RECORDS THERE ARE */
+typedef struct {
+    int magic;
+    int version;
+    int shard_count;
+    int student_count;
+    int ticket_count;
+    int next_ticket_id;
+    int generation;                     // VERSION 2: BUMPED ON EVERY SAVE, MATCHED BY indexes.dat
+} ShardFileHeader;
+
+/* SHARD-LOCAL INDEX: EACH SHARD'S RECORDS ARE A RANGE OF shard_student_pos[] AND
+   shard_ticket_pos[], HOLDING POSITIONS IN students[] AND tickets[] */
+typedef struct {
+    char key[SHARD_KEY_SIZE];           // FILE NAME PART, DERIVED FROM hostel_block
+    int first_student;
+    int student_count;
+    int first_ticket;
+    int ticket_count;
+} Shard;
+
+/* ONE SHARD'S FILES, READ BY ITS OWN THREAD AND MERGED AFTERWARDS */
+typedef struct {
+    char key[SHARD_KEY_SIZE];
+    Student *students;
+    int *student_pos;                   // ARRAY POSITIONS SAVED AFTER THE RECORDS, OR NULL
+    int student_count;
+    int students_taken;
+    Ticket *tickets;
+    int *ticket_pos;
+    int ticket_count;
+    int tickets_taken;
+    int next_ticket_id;
+} ShardLoad;
+
+/* ONE INDEX ENTRY: A KEY (STUDENT OR TICKET ID) AND THE RECORD'S ARRAY POSITION */
+typedef struct {
+    int key;
+    int pos;
+} IndexEntry;
+
+/* indexes.dat = HEADER, STUDENT ID INDEX, TICKET ID INDEX, ISSUE OWNER INDEX, NAME PIECE
+   BUCKET STARTS (NAME_GRAM_BUCKETS + 1), NAME PIECE POSITIONS. ONLY USED WHEN generation
+   MATCHES shards.dat AND checksum MATCHES THE ARRAYS */
+typedef struct {
+    int magic;
+    int version;
+    int generation;
+    int student_count;
+    int ticket_count;
+    int gram_count;                     // NAME PIECE POSITIONS
+    unsigned int checksum;              // OF EVERYTHING AFTER THE HEADER
+} IndexFileHeader;
+
+/* indexes.dat AS READ BY ITS LOADER THREAD */
+typedef struct {
+    IndexFileHeader header;
+    IndexEntry *student_ids;
+    IndexEntry *ticket_ids;
+    IndexEntry *ticket_owners;
+    int *gram_start;
+    int *gram_pos;
+    int complete;
+} IndexLoad;
+
+/* DASHBOARD FIGURES FOR ONE SHARD, ADDED UP ACROSS SHARDS */
+typedef struct {
+    int students;
+    int active;
+    int campus_a;
+    int campus_b;
+    int tickets;
+    int open_issues;
+} ShardSummary;
+
+/* ONE GATE SCAN. hostel_block IS THE STUDENT'S BLOCK AT THE TIME */
+typedef struct {
+    int student_id;
+    unsigned int at;
+    char hostel_block[10];
+    char direction;                     // GATE_OUT / GATE_IN
+    char reserved;
+} GateEvent;
+
+/* A GATE DAY FILE IS A RUN OF SEGMENTS: THIS HEADER, THEN event_count EVENTS IN TIME ORDER */
+typedef struct {
+    int magic;
+    int event_count;
+    unsigned int min_time;
+    unsigned int max_time;
+    unsigned int block_mask;            // OR OF gate_block_bit() OVER ITS EVENTS
+} GateSegmentHeader;
+
+/* A STUDENT CURRENTLY OUTSIDE (LAST SCAN WAS OUT) */
+typedef struct {
+    int student_id;
+    unsigned int since;
+    char hostel_block[10];
+} GateOutside;
+
+/* gate_outside.dat = THIS HEADER AND THE OUTSIDE SET, VALID UP TO through_offset OF THE
+   through_day FILE */
+typedef struct {
+    int magic;
+    int version;
+    int count;
+    int through_day;
+    unsigned int through_offset;
+    unsigned int last_event;
+} GateOutsideHeader;
+
+/* STATE OF A WALK OVER THE GATE LOG */
+typedef struct {
+    int student_id;
+    unsigned int last_out;
+    int shown;
+} MovementScan;
+
+typedef struct {
+    unsigned int curfew_start;
+    char hostel_block[10];
+    GateOutside *open;                  // WENT OUT SINCE THE MORNING, NOT BACK YET
+    int open_count;
+    int violations;
+} CurfewScan;
+
+/* THREAD PRIMITIVES: WIN32 ON WINDOWS, PTHREADS ELSEWHERE */
+#ifdef _WIN32
+typedef HANDLE hms_thread;
+typedef CRITICAL_SECTION hms_mutex;
+typedef CONDITION_VARIABLE hms_cond;
+#else
+typedef pthread_t hms_thread;
+typedef pthread_mutex_t hms_mutex;
+typedef pthread_cond_t hms_cond;
+#endif
+
+typedef struct {
+    void (*fn)(void *);
+    void *arg;
+} ThreadStart;
+
 /* GLOBAL ARRAYS AND COUNTERS */
 Student students[MAX_STUDENTS];
 int student_count = 0;
@@ -72,9 +475,223 @@ Ticket tickets[MAX_TICKETS];
 int ticket_count = 0;
 int next_ticket_id = 1;
 
+Room rooms[MAX_ROOMS];
+int room_count = 0;
+
+/* OCCUPANCY IS DERIVED FROM ACTIVE STUDENTS AND NOT STORED IN rooms.dat */
+unsigned int room_bed_mask[MAX_ROOMS];                  // BIT b SET = BED b TAKEN
+int room_bed_student[MAX_ROOMS][MAX_BEDS_PER_ROOM];     // STUDENT ID IN EACH BED
+int room_block[MAX_ROOMS];                              // INDEX INTO blocks[]
+BlockInventory blocks[MAX_BLOCKS];
+int block_count = 0;
+int room_overbooked = 0;                                // STUDENTS WITH NO BED LEFT IN THEIR ROOM
+
+/* OPEN (NOT RESOLVED) TICKETS BY CREATION DAY. A SLOT IS REUSED FOR A NEWER DAY
+   ONCE ITS OWN DAY IS SLA_DAY_SLOTS OLD, AND ITS COUNT THEN MOVES TO sla_open_older */
+int sla_open_day_count[SLA_DAY_SLOTS];
+unsigned int sla_open_day_tag[SLA_DAY_SLOTS];
+int sla_open_older = 0;
+int sla_untracked = 0;                                  // MIGRATED TICKETS WITH NO TIMESTAMPS
+SlaBlockStats sla_blocks[MAX_BLOCKS + 1];                // LAST ROW ADDS UP EVERY BLOCK PAST MAX_BLOCKS
+int sla_block_count = 0;
+
+/* PAGES CHANGED SINCE THE LAST CAPTURE. cow_base IS THAT CAPTURE, SO A NEW ONE
+   COPIES ONLY DIRTY PAGES AND TAKES THE REST FROM IT */
+unsigned char student_page_dirty[STUDENT_PAGES];
+unsigned char ticket_page_dirty[TICKET_PAGES];
+Snapshot cow_base;
+Snapshot snapshots[MAX_SNAPSHOTS];
+int snapshot_count = 0;
+int next_snapshot_id = 1;
+int actions_since_snapshot = 0;
+int changes_since_snapshot = 0;
+int unsaved_changes = 0;
+
+/* BACKGROUND WRITER. ONLY THE MENU THREAD TOUCHES PAGE REFERENCE COUNTS: THE WRITER
+   READS A JOB'S PAGES AND HANDS THE JOB BACK ON persist_done FOR FREEING */
+hms_mutex persist_lock;
+hms_cond persist_work;                  // SIGNALLED WHEN A JOB OR A FLUSH / STOP ARRIVES
+hms_cond persist_written;               // SIGNALLED WHEN THE WRITER FINISHES A JOB
+hms_thread persist_thread;
+int persist_running = 0;
+int persist_stopping = 0;
+int persist_flush_now = 0;
+int persist_writing = 0;
+long long persist_first_request = 0;
+long long persist_last_request = 0;
+PersistJob *persist_pending = NULL;     // NEWEST UNWRITTEN STATE, OLDER ONES ARE DROPPED
+PersistJob *persist_done = NULL;
+Snapshot persist_base;                  // LAST GENERATION HANDED TO THE WRITER (MENU THREAD)
+int persist_base_valid = 0;
+
+/* SHARD FILES ON DISK. OWNED BY THE WRITER ONCE IT IS RUNNING */
+char written_shards[MAX_SHARDS][SHARD_KEY_SIZE];
+int written_shard_count = 0;
+int rewrite_all_shards = 0;             // SET AFTER A FAILED WRITE, SO NOTHING IS LOST
+int legacy_files_present = 0;           // students.dat / tickets.dat STILL TO BE REMOVED
+int data_generation = 0;                // OF THE LAST shards.dat WRITTEN OR READ
+
+/* SHARD-LOCAL INDEX, REBUILT WHEN THE STORES HAVE CHANGED SINCE IT WAS LAST BUILT */
+Shard shards[MAX_SHARDS];
+int shard_count = 0;
+int shard_student_pos[MAX_STUDENTS];
+int shard_ticket_pos[MAX_TICKETS];
+int shard_index_stale = 1;
+
+/* RECORD INDEXES. ADDING A RECORD UPDATES THEM IN PLACE; ANYTHING THAT MOVES RECORDS
+   (SORT, ARCHIVE, RESTORE, LOAD) MARKS THEM STALE AND THEY ARE REBUILT ON NEXT USE */
+IndexEntry student_id_index[MAX_STUDENTS];      // BY STUDENT ID
+IndexEntry ticket_id_index[MAX_TICKETS];        // BY TICKET ID
+IndexEntry ticket_owner_index[MAX_TICKETS];     // BY STUDENT ID, THEN TICKET POSITION
+int student_index_stale = 1;
+int ticket_index_stale = 1;
+
+/* NAME SEARCH INDEX: FOR EVERY HASHED 3-CHARACTER PIECE, THE POSITIONS OF THE STUDENTS
+   WHOSE NAME HOLDS IT, IN POSITION ORDER. BUCKET b IS name_gram_pos[name_gram_start[b]]
+   UP TO name_gram_pos[name_gram_start[b + 1]]. STUDENTS APPENDED AFTER THE BUILD (FROM
+   name_gram_students ON) ARE NOT IN IT AND ARE CHECKED ONE BY ONE */
+int name_gram_start[NAME_GRAM_BUCKETS + 1];
+int *name_gram_pos = NULL;
+int name_gram_students = 0;
+int name_index_stale = 1;
+Snapshot *index_generation = NULL;              // GENERATION THE WRITER IS INDEXING
+
+/* GATE LOG. THE OUTSIDE SET IS KEPT UP TO DATE ON EVERY SCAN, SORTED BY STUDENT ID */
+GateEvent gate_batch[GATE_BATCH_EVENTS];        // QUEUED, NOT YET IN A DAY FILE
+int gate_batch_count = 0;
+GateOutside gate_outside[MAX_STUDENTS];
+int gate_outside_count = 0;
+unsigned int gate_last_event = 0;               // NEWER SCANS MAY NOT BE OLDER THAN THIS
+int gate_tail_day = -1;                         // END OF THE LOG ON DISK
+unsigned int gate_tail_offset = 0;
+
+/* ARCHIVE INDEX IS READ ON THE FIRST ARCHIVE LOOKUP, NEVER AT STARTUP */
+ArchiveHeader archive_header;
+ArchiveBlock *archive_index = NULL;
+int archive_index_loaded = 0;
+int archive_damaged = 0;                        // archive.dat EXISTS BUT ITS HEADER OR INDEX IS UNREADABLE
+
+#define TEXT_FIELD(type, field) { offsetof(type, field), sizeof(((type *)0)->field) }
+
+#define STUDENT_TEXT_FIELD(field, size, label, hint, group) TEXT_FIELD(Student, field),
+#define STUDENT_FIELD_ROW(field, size, label, hint, group) \
+    { #field, label, hint, offsetof(Student, field), sizeof(((Student *)0)->field), group },
+
+const TextField student_text_fields[] = { STUDENT_FIELDS(STUDENT_TEXT_FIELD) };
+const StudentField student_fields[] = { STUDENT_FIELDS(STUDENT_FIELD_ROW) };
+
+#define STUDENT_FIELD_COUNT ((int)(sizeof(student_fields) / sizeof(StudentField)))
+#define COLUMN_ID STUDENT_FIELD_COUNT       /* IMPORT / EXPORT COLUMNS BEYOND THE TEXT FIELDS */
+#define COLUMN_ACTIVE (STUDENT_FIELD_COUNT + 1)
+#define STUDENT_COLUMNS (STUDENT_FIELD_COUNT + 2)
+
+const char *const student_group_names[FIELD_GROUPS + 1] = {
+    "", "BASIC INFO", "CONTACT INFO", "ACADEMIC INFO", "HOSTEL INFO", "PERSONAL INFO", "FEE DETAILS", "LOCATION"
+};
+
+const TextField ticket_text_fields[] = {
+    TEXT_FIELD(Ticket, student_name), TEXT_FIELD(Ticket, issue),
+    TEXT_FIELD(Ticket, status), TEXT_FIELD(Ticket, hostel_block)
+};
+
 /* FUNCTION PROTOTYPES */
 void load_data();
 void save_data();
+int load_students(FILE *fp);
+int load_tickets(FILE *fp);
+int load_rooms(FILE *fp);
+int finish_load();
+int append_student(Student *s);
+int append_ticket(Ticket *t);
+
+/* BACKGROUND PERSISTENCE FUNCTIONS */
+void persist_start();
+void persist_shutdown();
+void persist_flush();
+void request_save();
+void persist_writer_loop(void *unused);
+void free_written_jobs();
+PersistJob *build_persist_job();
+void release_persist_job(PersistJob *job);
+int write_persist_job(PersistJob *job);
+int write_file_replace(const char *path, const void *header, size_t header_size,
+                       const void *records, size_t record_size, int record_count);
+int replace_file(const char *tmp_path, const char *path);
+void note_store_change();
+long long monotonic_ms();
+
+/* SHARDED STORAGE FUNCTIONS */
+void shard_key(const char *hostel_block, char *key);
+int shard_slot(char keys[][SHARD_KEY_SIZE], int *count, const char *key, int add);
+int read_shard_manifest(FILE *fp, ShardFileHeader *header, char keys[][SHARD_KEY_SIZE]);
+int load_sharded_data();
+int find_shard_files(char keys[][SHARD_KEY_SIZE]);
+void add_found_shard(const char *file, char keys[][SHARD_KEY_SIZE], int *count);
+int shard_key_valid(const char *key, int length);
+int compare_shard_keys(const void *a, const void *b);
+int legacy_files_exist();
+void load_shard_files(void *arg);
+int merge_loaded_shards(ShardLoad *loads, int count, ShardFileHeader *header,
+                        unsigned char *student_order, unsigned char *ticket_order);
+int *read_record_positions(FILE *fp, int count);
+void order_from_positions(ShardLoad *loads, int count, int total, unsigned char *order, int is_tickets);
+int read_student_file(FILE *fp, Student *out, int capacity);
+int read_ticket_file(FILE *fp, Ticket *out, int capacity, int *next_id);
+void collect_dirty_shards(PersistJob *job);
+void diff_shard_pages(PersistJob *job, SnapshotPage **old_pages, int old_count,
+                      SnapshotPage **new_pages, int new_count, size_t record_size, size_t block_offset);
+void add_dirty_shard(PersistJob *job, const char *hostel_block);
+void merge_dirty_shards(PersistJob *job, PersistJob *older);
+int write_shard_files(PersistJob *job);
+int write_shard_file(const char *path, const void *header, size_t header_size,
+                     SnapshotPage **pages, int page_count, size_t record_size,
+                     const unsigned char *order, int shard, int count);
+void shard_file_name(char *path, int size, const char *pattern, const char *key);
+void remove_shard_files();
+void rebuild_shard_index();
+void summarize_shard(int s, ShardSummary *out);
+int peek_record_count(FILE *fp, int is_tickets);
+
+/* RECORD INDEX FUNCTIONS */
+void ensure_record_indexes();
+void note_records_moved();
+void rebuild_record_indexes();
+void build_student_id_index(void *unused);
+void build_ticket_id_index(void *unused);
+void build_ticket_owner_index(void *unused);
+void build_name_index(void *unused);
+int compare_index_entries(const void *a, const void *b);
+int compare_student_names(const void *a, const void *b);
+const char *live_name(int pos);
+const char *generation_name(int pos);
+int name_grams(const char *name, int *buckets);
+int build_name_grams(const char *(*name_at)(int pos), int count, int *starts, int **positions);
+int find_name_matches(const char *text, int *matches);
+int index_lower_bound(IndexEntry *index, int count, int key);
+void index_insert(IndexEntry *index, int count, int key, int pos);
+void index_add_student(int pos);
+void index_add_ticket(int pos);
+int drop_duplicate_ids();
+const char *validate_record_indexes();
+void load_index_file(void *arg);
+int adopt_index_file(IndexLoad *load);
+int write_index_file(Snapshot *gen, int generation);
+unsigned int index_checksum(unsigned int sum, const int *words, size_t count);
+unsigned int index_file_checksum(const IndexFileHeader *h, const IndexEntry *student_ids, const IndexEntry *ticket_ids,
+                                 const IndexEntry *ticket_owners, const int *gram_start, const int *gram_pos);
+int index_positions_valid(const IndexEntry *index, int count, int limit);
+int write_index_arrays(Snapshot *gen, int generation, IndexEntry *student_ids, IndexEntry *ticket_ids,
+                       IndexEntry *ticket_owners, int *gram_start);
+void hms_mutex_init(hms_mutex *m);
+void hms_mutex_lock(hms_mutex *m);
+void hms_mutex_unlock(hms_mutex *m);
+void hms_cond_init(hms_cond *c);
+void hms_cond_wait(hms_cond *c, hms_mutex *m);
+void hms_cond_timedwait(hms_cond *c, hms_mutex *m, long long ms);
+void hms_cond_broadcast(hms_cond *c);
+int hms_thread_start(hms_thread *t, void (*fn)(void *), void *arg);
+void hms_thread_join(hms_thread t);
+void terminate_text_fields(void *record, const TextField *fields, int field_count);
 
 void main_menu();
 void admin_login();
@@ -95,6 +712,12 @@ void dashboard();
 void export_students_report();
 
 int find_student_by_id(int id);
+int insert_student(Student *s);
+char *student_text(const Student *s, const StudentField *f);
+void read_student_field(const char *verb, const StudentField *f, char *buffer);
+int set_student_field(int index, const StudentField *f, const char *value);
+void soft_delete_student(int index);
+void sort_students(int by_room);
 void print_student_row(Student s);
 void print_student_table_header();
 void print_line();
@@ -107,6 +730,139 @@ void view_all_tickets();
 void view_open_tickets();
 void update_ticket_status();
 int find_ticket_by_id(int tid);
+void open_ticket(Ticket *t, int student_index);
+void set_ticket_status(int index, int new_status);
+int ticket_status_code(const char *status);
+const char *ticket_status_name(int code);
+void log_ticket_transition(int ticket_id, unsigned int at, int from, int to);
+
+/* ISSUE SLA FUNCTIONS */
+void sla_menu();
+void view_sla_metrics();
+void view_ticket_history();
+void export_sla_json();
+void rebuild_sla_stats();
+void sla_track_open(Ticket *t, int delta);
+void sla_track_resolution(Ticket *t, int delta);
+SlaBlockStats *sla_block(const char *name);
+int sla_bucket(unsigned int secs);
+unsigned int sla_bucket_upper(int bucket);
+unsigned int sla_percentile(SlaBlockStats *b, int percent);
+void sla_open_age_histogram(unsigned int now, int out[5]);
+int scan_breaching_tickets(unsigned int now, int print);
+void format_time(unsigned int t, char *buf, int size);
+
+/* ROOM INVENTORY FUNCTIONS */
+void room_inventory_menu();
+void add_room();
+void view_all_rooms();
+void view_rooms_with_vacancy();
+void find_free_bed_in_block();
+void bulk_allocate_rooms();
+void print_room_table_header();
+void print_room_row(int r);
+int find_room(const char *block, const char *room_no);
+int find_block(const char *name);
+int add_block(const char *name);
+int room_reserve_bed(int r, int student_id);
+void room_release_student(const char *block, const char *room_no, int student_id);
+int first_free_room_in_block(int b);
+int claim_student_room(Student *s);
+int move_student_room(int index, const char *new_block, const char *new_room);
+int insert_room(Room *room, int *occupants);
+int allocate_unassigned_students(int *moved_block, int *waiting);
+void rebuild_room_occupancy();
+unsigned int room_full_mask(int capacity);
+int lowest_set_bit(unsigned int x);
+int count_set_bits(unsigned int x);
+
+/* SNAPSHOT FUNCTIONS */
+void snapshot_menu();
+void take_snapshot(int automatic);
+void snapshot_tick();
+void list_snapshots();
+void restore_snapshot();
+int restore_generation(Snapshot *snap, int *archived_students, int *archived_tickets);
+void drop_archived_records(int *archived_students, int *archived_tickets);
+void diff_snapshots();
+int find_snapshot(int id);
+void mark_student_dirty(int index);
+void mark_ticket_dirty(int index);
+void mark_all_dirty();
+int capture_generation(Snapshot *snap);
+int copy_generation(Snapshot *dst, Snapshot *src);
+void release_generation(Snapshot *snap);
+SnapshotPage *capture_page(const void *records, int count, size_t record_size);
+void release_page(SnapshotPage *page);
+const void *snapshot_find_record(SnapshotPage **pages, int page_count, size_t record_size, int id);
+int diff_pages(SnapshotPage **old_pages, int old_count, SnapshotPage **new_pages, int new_count,
+               size_t record_size, int print_students);
+
+/* ARCHIVE FUNCTIONS */
+void archive_menu();
+void archive_old_records();
+void archive_summary();
+void search_archived_student();
+void search_archived_ticket();
+int archive_load_index();
+int archive_read_index(FILE *fp, ArchiveHeader *header, ArchiveBlock **index);
+int archive_write(Student *old_students, int n_students, Ticket *old_tickets, int n_tickets);
+int archive_fetch(int kind, int id, void *out);
+void normalize_record(void *record, size_t record_size, const TextField *fields, int field_count);
+int compare_student_ids(const void *a, const void *b);
+int lz_compress(const unsigned char *in, int n, unsigned char *out);
+int lz_decompress(const unsigned char *in, int n, unsigned char *out, int capacity);
+void print_ticket_details(Ticket *t);
+
+/* STUDENT IMPORT / EXPORT FUNCTIONS */
+void student_transfer_menu();
+void export_students_file(int jsonl);
+void import_students_file(int jsonl);
+void list_student_columns();
+int find_student_column(const char *name);
+int parse_column_list(const char *list, int *columns);
+int write_student_export(FILE *fp, int jsonl, const int *columns, int column_count);
+int csv_put(char *out, int pos, const char *text);
+int json_put(char *out, int pos, const char *text);
+int read_csv_row(FILE *fp, char cells[][IMPORT_CELL_SIZE], int max_cells);
+int parse_json_object(const char *line, char keys[][IMPORT_CELL_SIZE], char values[][IMPORT_CELL_SIZE], int max_pairs);
+const char *json_string(const char *p, char *out, int size);
+void import_students(FILE *fp, int jsonl, ImportTally *tally);
+const char *import_student_row(const char **values, ImportTally *tally);
+int parse_active(const char *text);
+
+/* GATE LOG FUNCTIONS */
+void gate_menu();
+void record_gate_event(int direction);
+void import_gate_events();
+void view_students_outside();
+void view_student_movements();
+void curfew_report();
+void print_movement(const GateEvent *e, void *arg);
+void print_curfew_row(int student_id, const char *block, unsigned int out_at, unsigned int back_at, const char *note);
+void curfew_visit(const GateEvent *e, void *arg);
+unsigned int local_time_at(int day, int month, int year, int hour);
+int gate_day(unsigned int t);
+void gate_file_name(char *path, int size, int day);
+unsigned int gate_block_bit(const char *block);
+int gate_set_find(GateOutside *set, int count, int student_id);
+void gate_set_apply(GateOutside *set, int *count, int capacity, const GateEvent *e);
+int gate_is_outside(int student_id);
+void gate_prune_outside();
+const char *gate_record(int student_id, int direction, unsigned int at);
+int gate_flush();
+void gate_cut_file(const char *path, long length);
+int gate_write_outside();
+int gate_read_header(FILE *fp, GateSegmentHeader *header);
+int gate_read_events(FILE *fp, const GateSegmentHeader *header, GateEvent *events);
+void gate_scan(unsigned int from, unsigned int to, unsigned int block_mask,
+               void (*visit)(const GateEvent *e, void *arg), void *arg);
+int gate_read_outside(FILE *fp, GateOutsideHeader *header);
+void gate_load();
+
+/* SELF-CHECK FUNCTIONS (USED BY THE FUZZ AND PROPERTY TEST BUILDS) */
+const char *check_store_invariants();
+const char *check_sla_matches_rebuild();
 
 /* HELPER INPUT FUNCTIONS */
 void clear_input_buffer();
@@ -115,783 +871,6003 @@ int read_int(char *prompt);
 
 /* ------------------------ MAIN ------------------------ */
 
+/* THE FUZZ, SELF TEST AND BENCHMARK BUILDS BRING THEIR OWN ENTRY POINT (SEE THE END OF THIS FILE) */
+#if !defined(HMS_FUZZ) && !defined(HMS_SELFTEST) && !defined(HMS_BENCH)
 int main() {
     load_data();
+    persist_start();
     main_menu();
-    save_data();
+    persist_shutdown();     // LAST CHANGES ARE ON DISK BEFORE THE PROGRAM ENDS
 
     printf("\n\nTHANK YOU FOR USING HOSTEL MANAGEMENT SYSTEM.\n");
     return 0;
 }
+#endif
 
 /* --------------------- DATA PERSISTENCE --------------------- */
 
+/* FILE CONTENTS ARE NOT TRUSTED: COUNTS ARE RANGE CHECKED, SHORT FILES KEEP ONLY
+   WHOLE RECORDS, TEXT IS TERMINATED AND DUPLICATE IDS ARE DROPPED */
 void load_data() {
     FILE *fp;
+    int repairs;
 
-    /* LOAD STUDENTS */
-    fp = fopen(STUDENT_FILE, "rb");
-    if (fp != NULL) {
-        fread(&student_count, sizeof(int), 1, fp);
-        if (student_count > 0 && student_count <= MAX_STUDENTS) {
-            fread(students, sizeof(Student), student_count, fp);
-        } else {
-            student_count = 0;
+    student_count = 0;
+    ticket_count = 0;
+    room_count = 0;
+    next_ticket_id = 1;
+    note_records_moved();
+    release_generation(&persist_base);
+    persist_base_valid = 0;
+    written_shard_count = 0;
+    legacy_files_present = 0;
+
+    /* LOAD STUDENTS AND TICKETS: ONE PAIR OF FILES PER SHARD, OR THE SINGLE
+       students.dat / tickets.dat OF OLDER VERSIONS (SPLIT UP ON THE FIRST SAVE) */
+    repairs = load_sharded_data();
+    if (repairs < 0) {
+        /* SHARD FILES FROM A FIRST SAVE THAT WAS CUT SHORT ARE REMOVED BY THE NEXT SAVE */
+        written_shard_count = find_shard_files(written_shards);
+        fp = fopen(STUDENT_FILE, "rb");
+        if (fp != NULL) {
+            load_students(fp);
+            fclose(fp);
+            legacy_files_present = 1;
+        }
+
+        fp = fopen(TICKET_FILE, "rb");
+        if (fp != NULL) {
+            load_tickets(fp);
+            fclose(fp);
+            legacy_files_present = 1;
         }
-        fclose(fp);
     }
 
-    /* LOAD TICKETS */
-    fp = fopen(TICKET_FILE, "rb");
+    /* LOAD ROOM INVENTORY */
+    fp = fopen(ROOM_FILE, "rb");
     if (fp != NULL) {
-        fread(&ticket_count, sizeof(int), 1, fp);
-        if (ticket_count > 0 && ticket_count <= MAX_TICKETS) {
-            fread(tickets, sizeof(Ticket), ticket_count, fp);
-        } else {
-            ticket_count = 0;
-        }
+        load_rooms(fp);
         fclose(fp);
     }
 
-    /* SET NEXT TICKET ID */
-    next_ticket_id = 1;
-    for (int i = 0; i < ticket_count; i++) {
-        if (tickets[i].ticket_id >= next_ticket_id) {
-            next_ticket_id = tickets[i].ticket_id + 1;
-        }
+    /* MEMORY MATCHES THE SHARD FILES, SO SAVES ONLY REWRITE SHARDS CHANGED FROM HERE ON */
+    if (finish_load() == 0 && repairs == 0) {
+        persist_base_valid = capture_generation(&persist_base);
     }
-}
 
-void save_data() {
-    FILE *fp;
+    /* GATE LOG: THE SAVED OUTSIDE SET, PLUS ANY SCANS LOGGED AFTER IT WAS WRITTEN */
+    gate_load();
+}
 
-    fp = fopen(STUDENT_FILE, "wb");
-    if (fp != NULL) {
-        fwrite(&student_count, sizeof(int), 1, fp);
-        fwrite(students, sizeof(Student), student_count, fp);
-        fclose(fp);
+void terminate_text_fields(void *record, const TextField *fields, int field_count) {
+    for (int f = 0; f < field_count; f++) {
+        ((char *)record)[fields[f].offset + fields[f].size - 1] = '\0';
     }
+}
 
-    fp = fopen(TICKET_FILE, "wb");
-    if (fp != NULL) {
-        fwrite(&ticket_count, sizeof(int), 1, fp);
-        fwrite(tickets, sizeof(Ticket), ticket_count, fp);
-        fclose(fp);
-    }
+/* DUPLICATE IDS ARE DROPPED LATER, BY finish_load() */
+int load_students(FILE *fp) {
+    student_count = read_student_file(fp, students, MAX_STUDENTS);
+    note_records_moved();
+    return student_count;
 }
 
-/* ------------------------ MENUS ------------------------ */
+int load_tickets(FILE *fp) {
+    ticket_count = read_ticket_file(fp, tickets, MAX_TICKETS, &next_ticket_id);
+    note_records_moved();
+    return ticket_count;
+}
 
-void main_menu() {
-    int choice;
-    do {
-        printf("\n===============================================\n");
-        printf("          HOSTEL MANAGEMENT SYSTEM\n");
-        printf("===============================================\n");
-        printf("1. ADMIN LOGIN\n");
-        printf("2. STUDENT ISSUE PORTAL\n");
-        printf("0. EXIT\n");
-        printf("===============================================\n");
-        choice = read_int("ENTER YOUR CHOICE: ");
+/* APPENDS A LOADED RECORD UNLESS THE STORE IS FULL */
+int append_student(Student *s) {
+    if (student_count >= MAX_STUDENTS) return 0;
+    students[student_count++] = *s;
+    return 1;
+}
 
-        switch (choice) {
-            case 1:
-                admin_login();
-                break;
-            case 2:
-                student_menu();
-                break;
-            case 0:
-                printf("\nEXITING SYSTEM AND SAVING DATA...\n");
-                break;
-            default:
-                printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
-        }
-    } while (choice != 0);
+int append_ticket(Ticket *t) {
+    if (ticket_count >= MAX_TICKETS) return 0;
+    tickets[ticket_count++] = *t;
+    return 1;
 }
 
-void admin_login() {
-    char password[50];
-    int attempts = 0;
+/* READS UP TO capacity WHOLE RECORDS INTO out AND CLEANS THEIR FIELDS. TOUCHES NO
+   GLOBALS, SO SHARD THREADS CAN READ SEVERAL FILES AT ONCE */
+int read_student_file(FILE *fp, Student *out, int capacity) {
+    int count = 0;
 
-    while (attempts < 3) {
-        printf("\nENTER ADMIN PASSWORD: ");
-        scanf("%49s", password);
-        clear_input_buffer();
-        if (strcmp(password, ADMIN_PASSWORD) == 0) {
-            printf("\nLOGIN SUCCESSFUL. WELCOME ADMIN.\n");
-            admin_menu();
-            return;
-        } else {
-            printf("\nWRONG PASSWORD. TRY AGAIN.\n");
-            attempts++;
-        }
+    if (fread(&count, sizeof(int), 1, fp) != 1 || count <= 0 || count > MAX_STUDENTS) {
+        return 0;
     }
-    printf("\nMAXIMUM ATTEMPTS REACHED. RETURNING TO MAIN MENU.\n");
+    if (count > capacity) count = capacity;
+    count = (int)fread(out, sizeof(Student), count, fp);
+    for (int i = 0; i < count; i++) {
+        terminate_text_fields(&out[i], student_text_fields, sizeof(student_text_fields) / sizeof(TextField));
+        out[i].is_active = out[i].is_active ? 1 : 0;
+    }
+    return count;
 }
 
-void admin_menu() {
-    int choice;
-    do {
-        printf("\n===============================================\n");
-        printf("              ADMIN MAIN MENU\n");
-        printf("===============================================\n");
-        printf("1. ADD NEW STUDENT\n");
-        printf("2. UPDATE STUDENT DETAILS\n");
-        printf("3. DELETE (SOFT DELETE) STUDENT\n");
-        printf("4. VIEW ALL STUDENTS (INCLUDING INACTIVE)\n");
-        printf("5. VIEW ONLY ACTIVE STUDENTS\n");
-        printf("6. SEARCH STUDENT BY ID\n");
-        printf("7. SEARCH STUDENT BY NAME\n");
-        printf("8. SORT STUDENTS BY NAME\n");
-        printf("9. SORT STUDENTS BY ROOM NUMBER\n");
-        printf("10. VIEW STUDENTS BY CAMPUS\n");
-        printf("11. DASHBOARD SUMMARY\n");
-        printf("12. EXPORT STUDENT REPORT TO FILE\n");
-        printf("13. RAISE ISSUE (ADMIN SIDE)\n");
-        printf("14. VIEW ALL ISSUES\n");
-        printf("15. VIEW ONLY OPEN ISSUES\n");
-        printf("16. UPDATE ISSUE STATUS\n");
-        printf("0. LOGOUT AND RETURN TO MAIN MENU\n");
-        printf("===============================================\n");
-        choice = read_int("ENTER YOUR CHOICE: ");
+/* VERSIONED HEADER, OR A BARE COUNT FOLLOWED BY TicketV1 RECORDS IN THE OLD LAYOUT */
+int read_ticket_file(FILE *fp, Ticket *out, int capacity, int *next_id) {
+    TicketFileHeader header;
+    int count;
 
-        switch (choice) {
-            case 1:  add_student(); break;
-            case 2:  update_student(); break;
-            case 3:  delete_student(); break;
-            case 4:  view_all_students(); break;
-            case 5:  view_active_students(); break;
-            case 6:  search_student_by_id(); break;
-            case 7:  search_student_by_name(); break;
-            case 8:  sort_students_by_name(); break;
-            case 9:  sort_students_by_room(); break;
-            case 10: view_students_by_campus(); break;
-            case 11: dashboard(); break;
-            case 12: export_students_report(); break;
-            case 13: raise_issue_admin(); break;
-            case 14: view_all_tickets(); break;
-            case 15: view_open_tickets(); break;
-            case 16: update_ticket_status(); break;
-            case 0: 
-                printf("\nLOGGING OUT OF ADMIN PANEL...\n");
+    memset(&header, 0, sizeof(header));
+    if (fread(&header.magic, sizeof(int), 1, fp) != 1) return 0;
+
+    if (header.magic == TICKET_FILE_MAGIC) {
+        if (fread(&header.version, sizeof(int), 3, fp) != 3) return 0;
+        count = header.count;
+        if (count <= 0 || count > MAX_TICKETS) count = 0;
+        if (count > capacity) count = capacity;
+        count = (int)fread(out, sizeof(Ticket), count, fp);
+        if (header.next_ticket_id > 0 && header.next_ticket_id < INT_MAX - MAX_TICKETS) {
+            *next_id = header.next_ticket_id;
+        }
+    } else {
+        count = header.magic;
+        if (count <= 0 || count > MAX_TICKETS) return 0;
+        if (count > capacity) count = capacity;
+        for (int i = 0; i < count; i++) {
+            TicketV1 old;
+            if (fread(&old, sizeof(TicketV1), 1, fp) != 1) {
+                count = i;
                 break;
-            default:
-                printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+            }
+            memset(&out[i], 0, sizeof(Ticket));
+            out[i].ticket_id = old.ticket_id;
+            out[i].student_id = old.student_id;
+            memcpy(out[i].student_name, old.student_name, sizeof(old.student_name));
+            memcpy(out[i].issue, old.issue, sizeof(old.issue));
+            memcpy(out[i].status, old.status, sizeof(old.status));
         }
+    }
 
-        save_data();  // SAVE AFTER EVERY CHANGE
-    } while (choice != 0);
+    for (int i = 0; i < count; i++) {
+        Ticket *t = &out[i];
+        terminate_text_fields(t, ticket_text_fields, sizeof(ticket_text_fields) / sizeof(TextField));
+        /* UNKNOWN STATUS TEXT BECOMES OPEN, SO EVERY TICKET IS IN EXACTLY ONE STATE */
+        strcpy(t->status, ticket_status_name(ticket_status_code(t->status)));
+        if (ticket_status_code(t->status) != TICKET_RESOLVED) t->resolved_at = 0;
+    }
+    return count;
 }
 
-void student_menu() {
-    int choice;
-    do {
-        printf("\n===============================================\n");
-        printf("           STUDENT ISSUE PORTAL\n");
-        printf("===============================================\n");
-        printf("1. RAISE NEW ISSUE\n");
-        printf("2. CHECK ISSUE STATUS\n");
-        printf("0. BACK TO MAIN MENU\n");
-        printf("===============================================\n");
-        choice = read_int("ENTER YOUR CHOICE: ");
+int load_rooms(FILE *fp) {
+    char seen_blocks[MAX_BLOCKS][10];
+    int count = 0, dropped = 0, seen = 0;
 
-        switch (choice) {
-            case 1: raise_issue_student_portal(); break;
-            case 2: check_issue_status_student_portal(); break;
-            case 0: printf("\nRETURNING TO MAIN MENU...\n"); break;
-            default: printf("\nINVALID CHOICE. TRY AGAIN.\n");
+    room_count = 0;
+    if (fread(&count, sizeof(int), 1, fp) != 1 || count <= 0 || count > MAX_ROOMS) {
+        return 0;
+    }
+    count = (int)fread(rooms, sizeof(Room), count, fp);
+
+    for (int i = 0; i < count; i++) {
+        Room room = rooms[i];
+        int b;
+        room.hostel_block[sizeof(room.hostel_block) - 1] = '\0';
+        room.room_no[sizeof(room.room_no) - 1] = '\0';
+
+        for (b = 0; b < seen && strcmp(seen_blocks[b], room.hostel_block) != 0; b++) {}
+        if (b == seen && seen < MAX_BLOCKS) {
+            strcpy(seen_blocks[seen++], room.hostel_block);
         }
-        save_data();
-    } while (choice != 0);
+        if (b == MAX_BLOCKS || room.room_no[0] == '\0' ||
+            room.capacity < 1 || room.capacity > MAX_BEDS_PER_ROOM ||
+            find_room(room.hostel_block, room.room_no) != -1) {
+            dropped++;
+            continue;
+        }
+        rooms[room_count++] = room;
+    }
+    return dropped;
 }
 
-/* ---------------------- STUDENT FUNCTIONS ---------------------- */
+/* DERIVED STATE, REBUILT ONCE ALL FILES ARE IN. RETURNS THE NUMBER OF RECORDS
+   DROPPED FOR A DUPLICATE ID */
+int finish_load() {
+    int dropped;
 
-int find_student_by_id(int id) {
-    for (int i = 0; i < student_count; i++) {
-        if (students[i].id == id) {
-            return i;
+    ensure_record_indexes();        // NOTHING TO DO IF indexes.dat WAS USED
+    dropped = drop_duplicate_ids();
+    rebuild_room_occupancy();
+
+    /* SET NEXT TICKET ID FROM THE HIGHEST ONE IN THE ID INDEX (NEVER BELOW THE ONE
+       SAVED IN THE HEADER) */
+    for (int e = ticket_count - 1; e >= 0; e--) {
+        if (ticket_id_index[e].key < INT_MAX - MAX_TICKETS) {
+            if (ticket_id_index[e].key >= next_ticket_id) next_ticket_id = ticket_id_index[e].key + 1;
+            break;
         }
     }
-    return -1;
+    rebuild_sla_stats();
+    mark_all_dirty();
+    return dropped;
 }
 
-void add_student() {
-    if (student_count >= MAX_STUDENTS) {
-        printf("\nSTUDENT LIMIT REACHED. CANNOT ADD MORE.\n");
-        return;
-    }
-
-    Student s;
-    int id;
-
-    printf("\nADDING NEW STUDENT\n");
-    printf("------------------\n");
-
-    id = read_int("ENTER UNIQUE STUDENT ID / ROLL NO: ");
-    if (find_student_by_id(id) != -1) {
-        printf("\nSTUDENT WITH THIS ID ALREADY EXISTS. DUPLICATES NOT ALLOWED.\n");
+/* SYNCHRONOUS SAVE, USED WHEN THE WRITER THREAD IS NOT RUNNING */
+void save_data() {
+    PersistJob *job = build_persist_job();
+    if (job == NULL) {
+        printf("\nWARNING: NOT ENOUGH MEMORY TO SAVE. THE CHANGES ARE KEPT AND SAVED WITH THE NEXT ONE.\n");
+        unsaved_changes++;
         return;
     }
-    s.id = id;
+    write_persist_job(job);
+    release_persist_job(job);
+}
 
-    read_string("ENTER STUDENT NAME: ", s.name, sizeof(s.name));
-    read_string("ENTER FATHER / PARENT NAME: ", s.parent_name, sizeof(s.parent_name));
-    read_string("ENTER MOTHER NAME: ", s.mother_name, sizeof(s.mother_name));
-    read_string("ENTER PHONE NUMBER: ", s.phone, sizeof(s.phone));
-    read_string("ENTER EMAIL ID: ", s.email, sizeof(s.email));
-    read_string("ENTER ROOM NUMBER: ", s.room_no, sizeof(s.room_no));
-    read_string("ENTER BLOOD GROUP: ", s.blood_group, sizeof(s.blood_group));
-    read_string("ENTER YEAR (I / II / III / IV): ", s.year, sizeof(s.year));
-    read_string("ENTER DEPARTMENT: ", s.department, sizeof(s.department));
-    read_string("ENTER CAMPUS: ", s.campus, sizeof(s.campus));
-    read_string("ENTER DISTRICT: ", s.district, sizeof(s.district));
-
-    /* EXTRA 10 FIELDS */
-    read_string("ENTER STATE: ", s.state, sizeof(s.state));
-    read_string("ENTER PINCODE: ", s.pincode, sizeof(s.pincode));
-    read_string("ENTER FULL ADDRESS: ", s.address, sizeof(s.address));
-    read_string("ENTER GUARDIAN NAME: ", s.guardian_name, sizeof(s.guardian_name));
-    read_string("ENTER GUARDIAN PHONE: ", s.guardian_phone, sizeof(s.guardian_phone));
-    read_string("ENTER DATE OF BIRTH (DD/MM/YYYY): ", s.dob, sizeof(s.dob));
-    read_string("ENTER GENDER: ", s.gender, sizeof(s.gender));
-    read_string("ENTER HOSTEL BLOCK: ", s.hostel_block, sizeof(s.hostel_block));
-    read_string("ENTER ADMISSION YEAR: ", s.admission_year, sizeof(s.admission_year));
-    read_string("ENTER FEE STATUS (PAID / NOT_PAID): ", s.fee_status, sizeof(s.fee_status));
+/* ------------------ BACKGROUND PERSISTENCE ------------------ */
 
-    s.is_active = 1;
+#ifdef _WIN32
+void hms_mutex_init(hms_mutex *m) { InitializeCriticalSection(m); }
+void hms_mutex_lock(hms_mutex *m) { EnterCriticalSection(m); }
+void hms_mutex_unlock(hms_mutex *m) { LeaveCriticalSection(m); }
+void hms_cond_init(hms_cond *c) { InitializeConditionVariable(c); }
+void hms_cond_wait(hms_cond *c, hms_mutex *m) { SleepConditionVariableCS(c, m, INFINITE); }
+void hms_cond_timedwait(hms_cond *c, hms_mutex *m, long long ms) { SleepConditionVariableCS(c, m, (DWORD)ms); }
+void hms_cond_broadcast(hms_cond *c) { WakeAllConditionVariable(c); }
 
-    students[student_count++] = s;
-    printf("\nSTUDENT ADDED SUCCESSFULLY.\n");
+DWORD WINAPI hms_thread_trampoline(LPVOID param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
 }
 
-/* NESTED SWITCH IMPLEMENTATION FOR FIELD UPDATE */
-void update_student() {
-    int id, index, choice;
-    printf("\nUPDATE STUDENT DETAILS\n");
-    printf("----------------------\n");
-
-    id = read_int("ENTER STUDENT ID TO UPDATE: ");
-    index = find_student_by_id(id);
-
-    if (index == -1) {
-        printf("\nSTUDENT NOT FOUND.\n");
-        return;
+int hms_thread_start(hms_thread *t, void (*fn)(void *), void *arg) {
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (start == NULL) return 0;
+    start->fn = fn;
+    start->arg = arg;
+    *t = CreateThread(NULL, 0, hms_thread_trampoline, start, 0, NULL);
+    if (*t == NULL) {
+        free(start);
+        return 0;
     }
+    return 1;
+}
 
-    printf("\nSELECT WHICH DETAIL TO UPDATE (NESTED MENU):\n");
-    printf("1. BASIC INFO (NAME, PARENT NAMES)\n");
-    printf("2. CONTACT INFO (PHONE, EMAIL, ADDRESS)\n");
-    printf("3. ACADEMIC INFO (YEAR, DEPARTMENT, CAMPUS)\n");
-    printf("4. HOSTEL INFO (ROOM, BLOCK)\n");
-    printf("5. PERSONAL INFO (BLOOD GROUP, DOB, GENDER)\n");
-    printf("6. FEE DETAILS\n");
-    printf("0. CANCEL\n");
+void hms_thread_join(hms_thread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
 
-    choice = read_int("ENTER YOUR OPTION: ");
+long long monotonic_ms() {
+    return (long long)GetTickCount64();
+}
+#else
+void hms_mutex_init(hms_mutex *m) { pthread_mutex_init(m, NULL); }
+void hms_mutex_lock(hms_mutex *m) { pthread_mutex_lock(m); }
+void hms_mutex_unlock(hms_mutex *m) { pthread_mutex_unlock(m); }
+void hms_cond_init(hms_cond *c) { pthread_cond_init(c, NULL); }
+void hms_cond_wait(hms_cond *c, hms_mutex *m) { pthread_cond_wait(c, m); }
+void hms_cond_broadcast(hms_cond *c) { pthread_cond_broadcast(c); }
 
-    switch (choice) {
-        case 1: {
-            int sub;
-            printf("\n1. UPDATE STUDENT NAME\n");
-            printf("2. UPDATE FATHER / PARENT NAME\n");
-            printf("3. UPDATE MOTHER NAME\n");
-            printf("0. BACK\n");
-            sub = read_int("ENTER CHOICE: ");
-            switch (sub) {
-                case 1: read_string("ENTER NEW STUDENT NAME: ", students[index].name, sizeof(students[index].name)); break;
-                case 2: read_string("ENTER NEW PARENT NAME: ", students[index].parent_name, sizeof(students[index].parent_name)); break;
-                case 3: read_string("ENTER NEW MOTHER NAME: ", students[index].mother_name, sizeof(students[index].mother_name)); break;
-                case 0: printf("\nNO CHANGE MADE.\n"); break;
-                default: printf("\nINVALID OPTION.\n"); break;
-            }
-            break;
-        }
-        case 2: {
-            int sub;
-            printf("\n1. UPDATE PHONE NUMBER\n");
-            printf("2. UPDATE EMAIL ID\n");
-            printf("3. UPDATE ADDRESS\n");
-            printf("4. UPDATE GUARDIAN NAME\n");
-            printf("5. UPDATE GUARDIAN PHONE\n");
-            printf("0. BACK\n");
-            sub = read_int("ENTER CHOICE: ");
-            switch (sub) {
-                case 1: read_string("ENTER NEW PHONE: ", students[index].phone, sizeof(students[index].phone)); break;
-                case 2: read_string("ENTER NEW EMAIL: ", students[index].email, sizeof(students[index].email)); break;
-                case 3: read_string("ENTER NEW ADDRESS: ", students[index].address, sizeof(students[index].address)); break;
-                case 4: read_string("ENTER NEW GUARDIAN NAME: ", students[index].guardian_name, sizeof(students[index].guardian_name)); break;
-                case 5: read_string("ENTER NEW GUARDIAN PHONE: ", students[index].guardian_phone, sizeof(students[index].guardian_phone)); break;
-                case 0: printf("\nNO CHANGE MADE.\n"); break;
-                default: printf("\nINVALID OPTION.\n"); break;
-            }
-            break;
-        }
-        case 3: {
-            int sub;
-            printf("\n1. UPDATE YEAR\n");
-            printf("2. UPDATE DEPARTMENT\n");
-            printf("3. UPDATE CAMPUS\n");
-            printf("4. UPDATE ADMISSION YEAR\n");
-            printf("0. BACK\n");
-            sub = read_int("ENTER CHOICE: ");
-            switch (sub) {
-                case 1: read_string("ENTER NEW YEAR: ", students[index].year, sizeof(students[index].year)); break;
-                case 2: read_string("ENTER NEW DEPARTMENT: ", students[index].department, sizeof(students[index].department)); break;
-                case 3: read_string("ENTER NEW CAMPUS : ", students[index].campus, sizeof(students[index].campus)); break;
-                case 4: read_string("ENTER NEW ADMISSION YEAR: ", students[index].admission_year, sizeof(students[index].admission_year)); break;
-                case 0: printf("\nNO CHANGE MADE.\n"); break;
-                default: printf("\nINVALID OPTION.\n"); break;
-            }
-            break;
-        }
-        case 4: {
-            int sub;
-            printf("\n1. UPDATE ROOM NUMBER\n");
-            printf("2. UPDATE HOSTEL BLOCK\n");
-            printf("0. BACK\n");
-            sub = read_int("ENTER CHOICE: ");
-            switch (sub) {
-                case 1: read_string("ENTER NEW ROOM NUMBER: ", students[index].room_no, sizeof(students[index].room_no)); break;
-                case 2: read_string("ENTER NEW HOSTEL BLOCK: ", students[index].hostel_block, sizeof(students[index].hostel_block)); break;
-                case 0: printf("\nNO CHANGE MADE.\n"); break;
-                default: printf("\nINVALID OPTION.\n"); break;
-            }
-            break;
-        }
-        case 5: {
-            int sub;
-            printf("\n1. UPDATE BLOOD GROUP\n");
-            printf("2. UPDATE DATE OF BIRTH\n");
-            printf("3. UPDATE GENDER\n");
-            printf("0. BACK\n");
-            sub = read_int("ENTER CHOICE: ");
-            switch (sub) {
-                case 1: read_string("ENTER NEW BLOOD GROUP: ", students[index].blood_group, sizeof(students[index].blood_group)); break;
-                case 2: read_string("ENTER NEW DOB (DD/MM/YYYY): ", students[index].dob, sizeof(students[index].dob)); break;
-                case 3: read_string("ENTER NEW GENDER: ", students[index].gender, sizeof(students[index].gender)); break;
-                case 0: printf("\nNO CHANGE MADE.\n"); break;
-                default: printf("\nINVALID OPTION.\n"); break;
-            }
-            break;
-        }
-        case 6: {
-            read_string("ENTER NEW FEE STATUS (PAID / NOT_PAID): ", students[index].fee_status, sizeof(students[index].fee_status));
-            break;
-        }
-        case 0:
-            printf("\nUPDATE CANCELLED.\n");
-            return;
-        default:
-            printf("\nINVALID MAIN OPTION.\n");
-            return;
+void hms_cond_timedwait(hms_cond *c, hms_mutex *m, long long ms) {
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += (time_t)(ms / 1000);
+    until.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
     }
-
-    printf("\nSTUDENT DETAILS UPDATED SUCCESSFULLY.\n");
+    pthread_cond_timedwait(c, m, &until);
 }
 
-void delete_student() {
-    int id, index;
-    printf("\nDELETE (SOFT) STUDENT\n");
-    printf("---------------------\n");
-    id = read_int("ENTER STUDENT ID TO DELETE: ");
-    index = find_student_by_id(id);
+void *hms_thread_trampoline(void *param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
 
-    if (index == -1) {
-        printf("\nSTUDENT NOT FOUND.\n");
-        return;
+int hms_thread_start(hms_thread *t, void (*fn)(void *), void *arg) {
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (start == NULL) return 0;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(t, NULL, hms_thread_trampoline, start) != 0) {
+        free(start);
+        return 0;
     }
-
-    students[index].is_active = 0;
-    printf("\nSTUDENT MARKED AS INACTIVE (SOFT DELETED).\n");
+    return 1;
 }
 
-void print_line() {
-    printf("---------------------------------------------------------------------------------------------\n");
+void hms_thread_join(hms_thread t) {
+    pthread_join(t, NULL);
 }
 
-void print_student_table_header() {
-    print_line();
-    printf("| ID  | NAME                 | ROOM | CAMPUS | YEAR | DEPT           | ACTIVE |\n");
-    print_line();
+long long monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
 }
+#endif
 
-void print_student_row(Student s) {
-    printf("| %-3d | %-20s | %-4s | %-6s | %-4s | %-14s | %-6s |\n",
-           s.id,
-           s.name,
-           s.room_no,
-           s.campus,
-           s.year,
-           s.department,
-           s.is_active ? "YES" : "NO");
+/* CALLED BY EVERY mark_*_dirty(), SO SAVES AND SNAPSHOTS KNOW SOMETHING CHANGED */
+void note_store_change() {
+    unsaved_changes++;
+    changes_since_snapshot++;
+    shard_index_stale = 1;
 }
 
-void view_all_students() {
-    if (student_count == 0) {
-        printf("\nNO STUDENTS IN DATABASE.\n");
-        return;
+/* CAPTURING A GENERATION COPIES ONLY PAGES CHANGED SINCE THE LAST CAPTURE */
+PersistJob *build_persist_job() {
+    PersistJob *job = malloc(sizeof(PersistJob));
+    if (job == NULL) return NULL;
+    if (!capture_generation(&job->generation)) {
+        free(job);
+        return NULL;
     }
-    printf("\nALL STUDENTS (ACTIVE + INACTIVE)\n");
-    print_student_table_header();
-    for (int i = 0; i < student_count; i++) {
-        print_student_row(students[i]);
-    }
-    print_line();
+    collect_dirty_shards(job);
+    memcpy(job->rooms, rooms, room_count * sizeof(Room));
+    job->room_count = room_count;
+    job->next = NULL;
+    return job;
 }
 
-void view_active_students() {
-    int found = 0;
-    printf("\nACTIVE STUDENTS ONLY\n");
-    print_student_table_header();
-    for (int i = 0; i < student_count; i++) {
-        if (students[i].is_active) {
-            print_student_row(students[i]);
-            found = 1;
-        }
+void release_persist_job(PersistJob *job) {
+    release_generation(&job->generation);
+    free(job);
+}
+
+/* WRITES TO path.tmp AND RENAMES IT OVER path, SO A CRASH MID-WRITE LEAVES THE OLD FILE */
+int write_file_replace(const char *path, const void *header, size_t header_size,
+                       const void *records, size_t record_size, int record_count) {
+    char tmp_path[64];
+    int ok;
+    FILE *fp;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL) return 0;
+
+    ok = fwrite(header, header_size, 1, fp) == 1;
+    if (ok && record_count > 0) {
+        ok = fwrite(records, record_size, record_count, fp) == (size_t)record_count;
     }
-    print_line();
-    if (!found) {
-        printf("\nNO ACTIVE STUDENTS FOUND.\n");
+    ok = fclose(fp) == 0 && ok;
+    if (!ok) {
+        remove(tmp_path);
+        return 0;
     }
+    return replace_file(tmp_path, path);
 }
 
-void search_student_by_id() {
-    int id, index;
-    printf("\nSEARCH STUDENT BY ID\n");
-    id = read_int("ENTER STUDENT ID: ");
-    index = find_student_by_id(id);
-    if (index == -1) {
-        printf("\nSTUDENT NOT FOUND.\n");
-        return;
-    }
-    print_student_table_header();
-    print_student_row(students[index]);
-    print_line();
+int replace_file(const char *tmp_path, const char *path) {
+#ifdef _WIN32
+    remove(path);           /* rename() DOES NOT REPLACE AN EXISTING FILE ON WINDOWS */
+#endif
+    return rename(tmp_path, path) == 0;
 }
 
-void search_student_by_name() {
-    char name[50];
-    int found = 0;
-    printf("\nSEARCH STUDENT BY NAME\n");
-    read_string("ENTER NAME (FULL OR PART): ", name, sizeof(name));
+int write_persist_job(PersistJob *job) {
+    int ok = write_shard_files(job);
+    ok = write_file_replace(ROOM_FILE, &job->room_count, sizeof(int),
+                            job->rooms, sizeof(Room), job->room_count) && ok;
+    return ok;
+}
 
-    print_student_table_header();
-    for (int i = 0; i < student_count; i++) {
-        if (strstr(students[i].name, name) != NULL) {
-            print_student_row(students[i]);
-            found = 1;
+void persist_writer_loop(void *unused) {
+    (void)unused;
+    hms_mutex_lock(&persist_lock);
+    for (;;) {
+        PersistJob *job;
+
+        while (persist_pending == NULL && !persist_stopping) {
+            hms_cond_wait(&persist_work, &persist_lock);
         }
-    }
-    print_line();
-    if (!found) {
-        printf("\nNO STUDENT MATCHING THIS NAME.\n");
-    }
-}
+        if (persist_pending == NULL) break;
 
-void sort_students_by_name() {
-    if (student_count <= 1) {
-        printf("\nNOT ENOUGH STUDENTS TO SORT.\n");
-        return;
-    }
-    for (int i = 0; i < student_count - 1; i++) {
-        for (int j = 0; j < student_count - i - 1; j++) {
-            if (strcmp(students[j].name, students[j + 1].name) > 0) {
-                Student temp = students[j];
-                students[j] = students[j + 1];
-                students[j + 1] = temp;
+        /* LET A BURST OF EDITS SETTLE, BUT NEVER HOLD A CHANGE BACK LONGER THAN THE LAG LIMIT */
+        while (!persist_stopping && !persist_flush_now) {
+            long long now = monotonic_ms();
+            long long deadline = persist_first_request + PERSIST_MAX_LAG_MS;
+            if (persist_last_request + PERSIST_COALESCE_MS < deadline) {
+                deadline = persist_last_request + PERSIST_COALESCE_MS;
             }
+            if (now >= deadline) break;
+            hms_cond_timedwait(&persist_work, &persist_lock, deadline - now);
+        }
+
+        job = persist_pending;
+        persist_pending = NULL;
+        persist_writing = 1;
+        hms_mutex_unlock(&persist_lock);
+
+        if (!write_persist_job(job)) {
+            fprintf(stderr, "\nWARNING: UNABLE TO SAVE DATA FILES.\n");
         }
+
+        hms_mutex_lock(&persist_lock);
+        persist_writing = 0;
+        job->next = persist_done;
+        persist_done = job;
+        hms_cond_broadcast(&persist_written);
     }
-    printf("\nSTUDENTS SORTED BY NAME.\n");
-    view_all_students();
+    hms_mutex_unlock(&persist_lock);
 }
 
-void sort_students_by_room() {
-    if (student_count <= 1) {
-        printf("\nNOT ENOUGH STUDENTS TO SORT.\n");
-        return;
-    }
-    for (int i = 0; i < student_count - 1; i++) {
-        for (int j = 0; j < student_count - i - 1; j++) {
-            if (strcmp(students[j].room_no, students[j + 1].room_no) > 0) {
-                Student temp = students[j];
-                students[j] = students[j + 1];
-                students[j + 1] = temp;
-            }
-        }
+void persist_start() {
+    hms_mutex_init(&persist_lock);
+    hms_cond_init(&persist_work);
+    hms_cond_init(&persist_written);
+    persist_stopping = 0;
+    persist_running = hms_thread_start(&persist_thread, persist_writer_loop, NULL);
+}
+
+/* FREES JOBS THE WRITER HAS FINISHED WITH (MENU THREAD ONLY) */
+void free_written_jobs() {
+    PersistJob *done;
+    hms_mutex_lock(&persist_lock);
+    done = persist_done;
+    persist_done = NULL;
+    hms_mutex_unlock(&persist_lock);
+
+    while (done != NULL) {
+        PersistJob *next = done->next;
+        release_persist_job(done);
+        done = next;
     }
-    printf("\nSTUDENTS SORTED BY ROOM NUMBER.\n");
-    view_all_students();
 }
 
-void view_students_by_campus() {
-    char campus[5];
-    int found = 0;
-    read_string("ENTER CAMPUS: ", campus, sizeof(campus));
+/* HANDS THE CURRENT STATE TO THE WRITER AND RETURNS AT ONCE. A JOB THE WRITER HAS NOT
+   STARTED YET IS REPLACED, SO A BURST OF EDITS BECOMES ONE WRITE */
+void request_save() {
+    PersistJob *job, *replaced;
 
-    printf("\nSTUDENTS IN CAMPUS: %s\n", campus);
-    print_student_table_header();
-    for (int i = 0; i < student_count; i++) {
-        if (strcmp(students[i].campus, campus) == 0) {
-            print_student_row(students[i]);
-            found = 1;
+    if (!persist_running) {
+        if (unsaved_changes > 0) {
+            unsaved_changes = 0;
+            save_data();
         }
+        return;
     }
-    print_line();
-    if (!found) {
-        printf("\nNO STUDENTS FOUND FOR THIS CAMPUS.\n");
+
+    free_written_jobs();
+    if (unsaved_changes == 0) return;
+    unsaved_changes = 0;
+
+    job = build_persist_job();
+    if (job == NULL) {
+        save_data();
+        return;
+    }
+
+    hms_mutex_lock(&persist_lock);
+    replaced = persist_pending;
+    if (replaced != NULL) {
+        merge_dirty_shards(job, replaced);  // ITS CHANGES ARE NOW ONLY IN THE NEW JOB
+    }
+    persist_pending = job;
+    persist_last_request = monotonic_ms();
+    if (replaced == NULL) persist_first_request = persist_last_request;
+    hms_cond_broadcast(&persist_work);
+    hms_mutex_unlock(&persist_lock);
+
+    if (replaced != NULL) {
+        release_persist_job(replaced);
     }
 }
 
-void dashboard() {
-    int total = student_count;
-    int active = 0;
-    int a = 0, b = 0;
-    int open_issues = 0;
+/* BLOCKS UNTIL EVERY CHANGE MADE SO FAR IS ON DISK */
+void persist_flush() {
+    request_save();
+    if (!persist_running) return;
 
-    for (int i = 0; i < student_count; i++) {
-        if (students[i].is_active) active++;
-        if (strcmp(students[i].campus, "A") == 0) a++;
-        if (strcmp(students[i].campus, "B") == 0) b++;
+    hms_mutex_lock(&persist_lock);
+    persist_flush_now = 1;
+    hms_cond_broadcast(&persist_work);
+    while (persist_pending != NULL || persist_writing) {
+        hms_cond_wait(&persist_written, &persist_lock);
     }
+    persist_flush_now = 0;
+    hms_mutex_unlock(&persist_lock);
+    free_written_jobs();
+}
 
-    for (int i = 0; i < ticket_count; i++) {
-        if (strcmp(tickets[i].status, "OPEN") == 0) open_issues++;
+void persist_shutdown() {
+    if (!persist_running) {
+        save_data();
+        return;
     }
+    persist_flush();
 
-    printf("\n=================== DASHBOARD SUMMARY ===================\n");
-    printf("TOTAL STUDENTS          : %d\n", total);
-    printf("ACTIVE STUDENTS         : %d\n", active);
-    printf("CAMPUS A STUDENTS       : %d\n", a);
-    printf("CAMPUS B STUDENTS       : %d\n", b);
-    printf("TOTAL ISSUES RAISED     : %d\n", ticket_count);
-    printf("OPEN ISSUES             : %d\n", open_issues);
-    printf("=========================================================\n");
+    hms_mutex_lock(&persist_lock);
+    persist_stopping = 1;
+    hms_cond_broadcast(&persist_work);
+    hms_mutex_unlock(&persist_lock);
+    hms_thread_join(persist_thread);
+    persist_running = 0;
+    free_written_jobs();
 }
 
-void export_students_report() {
-    FILE *fp = fopen(REPORT_FILE, "w");
-    if (fp == NULL) {
-        printf("\nUNABLE TO CREATE REPORT FILE.\n");
-        return;
+/* -------------------- SHARDED STORAGE -------------------- */
+
+/* hostel_block AS A FILE NAME PART: LETTERS (UPPER CASE), DIGITS, ANYTHING ELSE '_'.
+   BLOCKS THAT MAP TO THE SAME KEY SIMPLY SHARE ONE SHARD */
+void shard_key(const char *hostel_block, char *key) {
+    int n;
+    for (n = 0; n < SHARD_KEY_SIZE - 1 && hostel_block[n] != '\0'; n++) {
+        char c = hostel_block[n];
+        if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+        key[n] = ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) ? c : '_';
     }
+    key[n] = '\0';
+    if (n == 0) strcpy(key, "NONE");
+}
 
-    fprintf(fp, "   HOSTEL MANAGEMENT SYSTEM - STUDENT REPORT\n");
-    fprintf(fp, "=============================================\n");
-    for (int i = 0; i < student_count; i++) {
-        Student s = students[i];
-        fprintf(fp, "ID: %d\n", s.id);
-        fprintf(fp, "NAME: %s\n", s.name);
-        fprintf(fp, "PARENT: %s\n", s.parent_name);
-        fprintf(fp, "MOTHER: %s\n", s.mother_name);
-        fprintf(fp, "PHONE: %s\n", s.phone);
-        fprintf(fp, "EMAIL: %s\n", s.email);
-        fprintf(fp, "ROOM: %s\n", s.room_no);
-        fprintf(fp, "BLOOD GROUP: %s\n", s.blood_group);
-        fprintf(fp, "YEAR: %s\n", s.year);
-        fprintf(fp, "DEPARTMENT: %s\n", s.department);
-        fprintf(fp, "CAMPUS: %s\n", s.campus);
-        fprintf(fp, "DISTRICT: %s\n", s.district);
-        fprintf(fp, "STATE: %s\n", s.state);
-        fprintf(fp, "PINCODE: %s\n", s.pincode);
-        fprintf(fp, "ADDRESS: %s\n", s.address);
-        fprintf(fp, "GUARDIAN: %s (%s)\n", s.guardian_name, s.guardian_phone);
-        fprintf(fp, "DOB: %s  GENDER: %s\n", s.dob, s.gender);
-        fprintf(fp, "HOSTEL BLOCK: %s\n", s.hostel_block);
-        fprintf(fp, "ADMISSION YEAR: %s\n", s.admission_year);
-        fprintf(fp, "FEE STATUS: %s\n", s.fee_status);
-        fprintf(fp, "ACTIVE: %s\n", s.is_active ? "YES" : "NO");
-        fprintf(fp, "---------------------------------------------\n");
+/* POSITION OF key IN keys[], ADDED WHEN add IS SET. ONCE THE LIST IS FULL EVERY NEW
+   KEY GOES TO THE LAST SHARD. -1 WHEN NOT FOUND AND NOT ADDED */
+int shard_slot(char keys[][SHARD_KEY_SIZE], int *count, const char *key, int add) {
+    for (int s = 0; s < *count; s++) {
+        if (strcmp(keys[s], key) == 0) return s;
     }
-    fclose(fp);
-    printf("\nSTUDENT REPORT EXPORTED TO FILE: %s\n", REPORT_FILE);
+    if (!add) return -1;
+    if (*count == MAX_SHARDS) return MAX_SHARDS - 1;
+    strcpy(keys[*count], key);
+    return (*count)++;
 }
 
-/* ---------------------- TICKET / ISSUE FUNCTIONS ---------------------- */
+void shard_file_name(char *path, int size, const char *pattern, const char *key) {
+    snprintf(path, size, pattern, key);
+}
 
-int find_ticket_by_id(int tid) {
-    for (int i = 0; i < ticket_count; i++) {
-        if (tickets[i].ticket_id == tid) {
-            return i;
+/* KEYS BECOME FILE NAMES, SO ONLY THE CHARACTERS shard_key() PRODUCES ARE ACCEPTED.
+   A BAD KEY IS LEFT EMPTY AND ITS SHARD IS SKIPPED. RETURNS 0 IF THE HEADER IS UNUSABLE */
+int read_shard_manifest(FILE *fp, ShardFileHeader *header, char keys[][SHARD_KEY_SIZE]) {
+    size_t got;
+
+    /* VERSION 1 HAS NO GENERATION, SO ITS INDEXES ARE NEVER TRUSTED. AN UNKNOWN VERSION IS
+       TREATED AS DAMAGED AND THE SHARD FILES ARE REBUILT FROM WHAT IS ON DISK */
+    header->generation = -1;
+    if (fread(header, offsetof(ShardFileHeader, generation), 1, fp) != 1 || header->magic != SHARD_MAGIC ||
+        header->version < 1 || header->version > SHARD_VERSION ||
+        (header->version >= 2 && fread(&header->generation, sizeof(int), 1, fp) != 1) ||
+        header->shard_count < 0 || header->shard_count > MAX_SHARDS ||
+        header->student_count < 0 || header->student_count > MAX_STUDENTS ||
+        header->ticket_count < 0 || header->ticket_count > MAX_TICKETS) {
+        return 0;
+    }
+
+    got = fread(keys, SHARD_KEY_SIZE, header->shard_count, fp);
+    for (int s = 0; s < header->shard_count; s++) {
+        if ((size_t)s >= got || memchr(keys[s], '\0', SHARD_KEY_SIZE) == NULL ||
+            !shard_key_valid(keys[s], (int)strlen(keys[s]))) {
+            keys[s][0] = '\0';
+            continue;
+        }
+        for (int d = 0; d < s && keys[s][0] != '\0'; d++) {
+            if (strcmp(keys[d], keys[s]) == 0) keys[s][0] = '\0';
         }
     }
-    return -1;
+    return 1;
 }
 
-void raise_issue_student_portal() {
-    if (ticket_count >= MAX_TICKETS) {
-        printf("\nTICKET LIMIT REACHED. CANNOT RAISE MORE ISSUES.\n");
-        return;
+/* 1 IF THE FIRST length CHARACTERS COULD HAVE COME FROM shard_key() */
+int shard_key_valid(const char *key, int length) {
+    if (length <= 0 || length >= SHARD_KEY_SIZE) return 0;
+    for (int n = 0; n < length; n++) {
+        if (!((key[n] >= 'A' && key[n] <= 'Z') || (key[n] >= '0' && key[n] <= '9') || key[n] == '_')) return 0;
     }
+    return 1;
+}
 
-    int id, index;
-    Ticket t;
+/* KEYS OF THE SHARD FILES IN THE DATA FOLDER, SORTED. USED WHEN shards.dat IS LOST,
+   SO THE RECORDS ARE REBUILT FROM THE FILES THEMSELVES */
+int find_shard_files(char keys[][SHARD_KEY_SIZE]) {
+    int count = 0;
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA("shard_*.dat", &found);
 
-    printf("\nRAISE ISSUE - STUDENT PORTAL\n");
-    id = read_int("ENTER YOUR STUDENT ID: ");
-    index = find_student_by_id(id);
+    if (search == INVALID_HANDLE_VALUE) return 0;
+    do {
+        add_found_shard(found.cFileName, keys, &count);
+    } while (FindNextFileA(search, &found));
+    FindClose(search);
+#else
+    DIR *dir = opendir(".");
+    struct dirent *entry;
 
-    if (index == -1 || !students[index].is_active) {
-        printf("\nSTUDENT NOT REGISTERED OR INACTIVE. ISSUE CANNOT BE RAISED.\n");
+    if (dir == NULL) return 0;
+    while ((entry = readdir(dir)) != NULL) add_found_shard(entry->d_name, keys, &count);
+    closedir(dir);
+#endif
+    qsort(keys, count, SHARD_KEY_SIZE, compare_shard_keys);
+    return count;
+}
+
+/* TAKES ONLY NAMES write_shard_files() COULD HAVE WRITTEN (NOT .tmp LEFTOVERS) */
+void add_found_shard(const char *file, char keys[][SHARD_KEY_SIZE], int *count) {
+    static const char *suffixes[2] = { "_students.dat", "_tickets.dat" };
+    size_t file_length = strlen(file);
+    char key[SHARD_KEY_SIZE];
+
+    if (strncmp(file, "shard_", 6) != 0) return;
+    for (int k = 0; k < 2; k++) {
+        size_t suffix_length = strlen(suffixes[k]);
+        int key_length;
+
+        if (file_length <= 6 + suffix_length || strcmp(file + file_length - suffix_length, suffixes[k]) != 0) continue;
+        key_length = (int)(file_length - 6 - suffix_length);
+        if (!shard_key_valid(file + 6, key_length)) return;
+        memcpy(key, file + 6, key_length);
+        key[key_length] = '\0';
+        if (*count < MAX_SHARDS) shard_slot(keys, count, key, 1);
         return;
     }
+}
 
-    t.ticket_id = next_ticket_id++;
-    t.student_id = id;
-    strcpy(t.student_name, students[index].name);
-    read_string("ENTER YOUR ISSUE (ROOM / HOSTEL PROBLEM): ", t.issue, sizeof(t.issue));
-    strcpy(t.status, "OPEN");
+int compare_shard_keys(const void *a, const void *b) {
+    return strcmp(a, b);
+}
 
-    tickets[ticket_count++] = t;
+/* students.dat / tickets.dat ARE ONLY REMOVED AFTER THE FIRST SHARDED SAVE IS COMPLETE */
+int legacy_files_exist() {
+    FILE *fp = fopen(STUDENT_FILE, "rb");
 
-    printf("\nISSUE RAISED SUCCESSFULLY.\n");
-    printf("YOUR TICKET ID IS: %d\n", t.ticket_id);
+    if (fp == NULL) fp = fopen(TICKET_FILE, "rb");
+    if (fp == NULL) return 0;
+    fclose(fp);
+    return 1;
 }
 
-void check_issue_status_student_portal() {
-    int tid, index;
-    printf("\nCHECK ISSUE STATUS\n");
-    tid = read_int("ENTER YOUR TICKET ID: ");
-    index = find_ticket_by_id(tid);
+/* THREAD BODY: READS ONE SHARD'S TWO FILES INTO ITS OWN BUFFERS */
+void load_shard_files(void *arg) {
+    ShardLoad *shard = arg;
+    char path[64];
+    FILE *fp;
 
-    if (index == -1) {
-        printf("\nNO SUCH TICKET FOUND.\n");
-        return;
+    int capacity;
+
+    /* BUFFERS ARE SIZED FROM EACH FILE'S OWN COUNT */
+    shard_file_name(path, sizeof(path), SHARD_STUDENT_FILE, shard->key);
+    fp = fopen(path, "rb");
+    if (fp != NULL) {
+        capacity = peek_record_count(fp, 0);
+        shard->students = malloc(capacity * sizeof(Student) + 1);
+        if (shard->students != NULL) shard->student_count = read_student_file(fp, shard->students, capacity);
+        shard->student_pos = read_record_positions(fp, shard->student_count);
+        fclose(fp);
     }
 
-    printf("\nTICKET DETAILS:\n");
-    printf("TICKET ID  : %d\n", tickets[index].ticket_id);
-    printf("STUDENT ID : %d\n", tickets[index].student_id);
-    printf("STUDENT    : %s\n", tickets[index].student_name);
-    printf("ISSUE      : %s\n", tickets[index].issue);
-    printf("STATUS     : %s\n", tickets[index].status);
+    shard_file_name(path, sizeof(path), SHARD_TICKET_FILE, shard->key);
+    fp = fopen(path, "rb");
+    if (fp != NULL) {
+        capacity = peek_record_count(fp, 1);
+        shard->tickets = malloc(capacity * sizeof(Ticket) + 1);
+        if (shard->tickets != NULL) shard->ticket_count = read_ticket_file(fp, shard->tickets, capacity, &shard->next_ticket_id);
+        shard->ticket_pos = read_record_positions(fp, shard->ticket_count);
+        fclose(fp);
+    }
 }
 
-void raise_issue_admin() {
-    if (ticket_count >= MAX_TICKETS) {
-        printf("\nTICKET LIMIT REACHED. CANNOT RAISE MORE ISSUES.\n");
-        return;
+/* THE POSITIONS THAT FOLLOW count RECORDS, OR NULL IF THE FILE ENDS FIRST */
+int *read_record_positions(FILE *fp, int count) {
+    int *positions = malloc(count * sizeof(int) + 1);
+
+    if (positions != NULL && count > 0 && fread(positions, sizeof(int), count, fp) != (size_t)count) {
+        free(positions);
+        positions = NULL;
     }
+    return positions;
+}
 
-    int id, index;
-    Ticket t;
+/* ORDER LIST FOR merge_loaded_shards() FROM THE SAVED POSITIONS. A POSITION THAT IS OUT
+   OF RANGE, TAKEN TWICE OR NOT RISING WITHIN ITS SHARD IS LEFT OUT; THE MERGE THEN FINDS
+   THE RECORD UNACCOUNTED FOR AND COUNTS IT AS A REPAIR */
+void order_from_positions(ShardLoad *loads, int count, int total, unsigned char *order, int is_tickets) {
+    memset(order, 0xFF, total);
+    for (int s = 0; s < count; s++) {
+        const int *positions = is_tickets ? loads[s].ticket_pos : loads[s].student_pos;
+        int records = is_tickets ? loads[s].ticket_count : loads[s].student_count;
+        int last = -1;
 
-    printf("\nRAISE ISSUE - ADMIN SIDE\n");
-    id = read_int("ENTER STUDENT ID: ");
-    index = find_student_by_id(id);
+        for (int i = 0; positions != NULL && i < records; i++) {
+            if (positions[i] <= last || positions[i] >= total || order[positions[i]] != 0xFF) continue;
+            order[positions[i]] = (unsigned char)s;
+            last = positions[i];
+        }
+    }
+}
 
-    if (index == -1 || !students[index].is_active) {
-        printf("\nSTUDENT NOT REGISTERED OR INACTIVE. ISSUE CANNOT BE RAISED.\n");
-        return;
+/* RECORD COUNT FROM A STUDENT OR TICKET FILE HEADER (0 IF UNUSABLE), FILE REWOUND */
+int peek_record_count(FILE *fp, int is_tickets) {
+    int head[4] = { 0, 0, 0, 0 };
+    int count = 0;
+
+    if (fread(head, sizeof(int), 1, fp) == 1) {
+        count = head[0];
+        if (is_tickets && head[0] == TICKET_FILE_MAGIC) {
+            count = fread(&head[1], sizeof(int), 3, fp) == 3 ? head[2] : 0;
+        }
     }
+    rewind(fp);
+    if (count <= 0) return 0;
+    return count > (is_tickets ? MAX_TICKETS : MAX_STUDENTS) ? (is_tickets ? MAX_TICKETS : MAX_STUDENTS) : count;
+}
 
-    t.ticket_id = next_ticket_id++;
-    t.student_id = id;
-    strcpy(t.student_name, students[index].name);
-    read_string("ENTER ISSUE DETAILS: ", t.issue, sizeof(t.issue));
-    strcpy(t.status, "OPEN");
+/* RETURNS -1 WHEN THE SINGLE FILES OF AN OLDER VERSION ARE TO BE READ INSTEAD, OTHERWISE
+   THE NUMBER OF RECORDS THAT WERE DROPPED OR DID NOT MATCH THE SAVED ORDER (0 = FILES ARE
+   EXACTLY AS LAST SAVED). WITHOUT A USABLE shards.dat THE SHARD FILES ON DISK ARE READ
+   IN KEY ORDER: THE SINGLE FILES ARE DELETED BY THE FIRST SHARDED SAVE, SO THEY ARE ONLY
+   TRUSTED WHILE THEY STILL EXIST */
+int load_sharded_data() {
+    static char keys[MAX_SHARDS][SHARD_KEY_SIZE];
+    static unsigned char student_order[MAX_STUDENTS];
+    static unsigned char ticket_order[MAX_TICKETS];
+    ShardFileHeader header;
+    ShardLoad loads[MAX_SHARDS];
+    IndexLoad index_load;
+    hms_thread threads[MAX_SHARDS], index_thread;
+    int started[MAX_SHARDS], index_started;
+    int repairs;
+    int have_manifest = 0;
+    FILE *fp = fopen(SHARD_FILE, "rb");
+
+    if (fp != NULL) {
+        have_manifest = read_shard_manifest(fp, &header, keys);
+        fclose(fp);
+    }
 
-    tickets[ticket_count++] = t;
+    if (have_manifest) {
+        legacy_files_present = legacy_files_exist();
+    } else if (legacy_files_exist()) {
+        /* THE FIRST SHARDED SAVE NEVER FINISHED: THE SINGLE FILES ARE STILL THE DATA */
+        if (fp != NULL) printf("\nWARNING: %s IS DAMAGED, READING THE SINGLE DATA FILES INSTEAD.\n", SHARD_FILE);
+        return -1;
+    } else {
+        memset(&header, 0, sizeof(header));
+        header.generation = -1;
+        header.student_count = -1;          // TOTALS ARE ADDED UP FROM THE FILES BELOW
+        header.shard_count = find_shard_files(keys);
+        if (header.shard_count == 0) {
+            if (fp != NULL) printf("\nWARNING: %s IS DAMAGED AND NO SHARD FILES WERE FOUND.\n", SHARD_FILE);
+            return 0;
+        }
+        printf("\nWARNING: %s IS %s. REBUILDING FROM %d SHARD FILE SET(S).\n",
+               SHARD_FILE, fp != NULL ? "DAMAGED" : "MISSING", header.shard_count);
+    }
 
-    printf("\nISSUE RAISED SUCCESSFULLY FOR STUDENT.\n");
-    printf("TICKET ID: %d\n", t.ticket_id);
+    /* ONE THREAD PER SHARD PLUS ONE FOR indexes.dat. A FILE WHOSE THREAD CANNOT START
+       IS READ RIGHT HERE */
+    memset(&index_load, 0, sizeof(index_load));
+    index_started = hms_thread_start(&index_thread, load_index_file, &index_load);
+    if (!index_started) load_index_file(&index_load);
+    memset(loads, 0, sizeof(loads));
+    for (int s = 0; s < header.shard_count; s++) {
+        started[s] = 0;
+        if (keys[s][0] == '\0') continue;
+        strcpy(loads[s].key, keys[s]);
+        started[s] = hms_thread_start(&threads[s], load_shard_files, &loads[s]);
+        if (!started[s]) load_shard_files(&loads[s]);
+    }
+    for (int s = 0; s < header.shard_count; s++) {
+        if (started[s]) hms_thread_join(threads[s]);
+    }
+
+    if (index_started) hms_thread_join(index_thread);
+
+    if (header.student_count < 0) {
+        header.student_count = 0;
+        header.ticket_count = 0;
+        for (int s = 0; s < header.shard_count; s++) {
+            header.student_count += loads[s].student_count;
+            header.ticket_count += loads[s].ticket_count;
+        }
+        if (header.student_count > MAX_STUDENTS) header.student_count = MAX_STUDENTS;
+        if (header.ticket_count > MAX_TICKETS) header.ticket_count = MAX_TICKETS;
+    }
+    order_from_positions(loads, header.shard_count, header.student_count, student_order, 0);
+    order_from_positions(loads, header.shard_count, header.ticket_count, ticket_order, 1);
+    repairs = merge_loaded_shards(loads, header.shard_count, &header, student_order, ticket_order);
+
+    /* INDEXES SAVED WITH THIS VERSION OF THE DATA ARE USED AS THEY ARE */
+    if (repairs == 0 && index_load.header.generation == header.generation) {
+        adopt_index_file(&index_load);
+    }
+    free(index_load.student_ids);
+    free(index_load.ticket_ids);
+    free(index_load.ticket_owners);
+    free(index_load.gram_start);
+    free(index_load.gram_pos);
+
+    data_generation = header.generation > 0 ? header.generation : 0;
+    written_shard_count = 0;
+    for (int s = 0; s < header.shard_count; s++) {
+        if (keys[s][0] != '\0') strcpy(written_shards[written_shard_count++], keys[s]);
+        free(loads[s].students);
+        free(loads[s].student_pos);
+        free(loads[s].tickets);
+        free(loads[s].ticket_pos);
+    }
+    return repairs;
 }
 
-void view_all_tickets() {
-    if (ticket_count == 0) {
-        printf("\nNO ISSUES RAISED YET.\n");
+/* PUTS THE RECORDS BACK IN THE SAVED ARRAY ORDER, THEN APPENDS ANY THE ORDER LIST
+   DID NOT ACCOUNT FOR (A SAVE CUT SHORT BETWEEN TWO FILES) */
+int merge_loaded_shards(ShardLoad *loads, int count, ShardFileHeader *header,
+                        unsigned char *student_order, unsigned char *ticket_order) {
+    int repairs = 0;
+
+    for (int i = 0; i < header->student_count; i++) {
+        ShardLoad *shard = &loads[student_order[i] < count ? student_order[i] : 0];
+        if (student_order[i] >= count || shard->students_taken == shard->student_count) {
+            repairs++;
+            continue;
+        }
+        repairs += !append_student(&shard->students[shard->students_taken++]);
+    }
+    for (int i = 0; i < header->ticket_count; i++) {
+        ShardLoad *shard = &loads[ticket_order[i] < count ? ticket_order[i] : 0];
+        if (ticket_order[i] >= count || shard->tickets_taken == shard->ticket_count) {
+            repairs++;
+            continue;
+        }
+        repairs += !append_ticket(&shard->tickets[shard->tickets_taken++]);
+    }
+
+    for (int s = 0; s < count; s++) {
+        while (loads[s].students_taken < loads[s].student_count) {
+            append_student(&loads[s].students[loads[s].students_taken++]);
+            repairs++;
+        }
+        while (loads[s].tickets_taken < loads[s].ticket_count) {
+            append_ticket(&loads[s].tickets[loads[s].tickets_taken++]);
+            repairs++;
+        }
+        if (loads[s].next_ticket_id > next_ticket_id) next_ticket_id = loads[s].next_ticket_id;
+    }
+    if (header->next_ticket_id > next_ticket_id && header->next_ticket_id < INT_MAX - MAX_TICKETS) {
+        next_ticket_id = header->next_ticket_id;
+    }
+    return repairs;
+}
+
+/* MENU THREAD: WHICH SHARDS DOES THIS JOB CHANGE COMPARED WITH THE LAST JOB? PAGES
+   SHARED WITH THAT JOB ARE SKIPPED UNREAD, OTHERS ARE COMPARED RECORD BY RECORD */
+void collect_dirty_shards(PersistJob *job) {
+    Snapshot *gen = &job->generation;
+
+    job->dirty_shard_count = 0;
+    job->all_shards_dirty = !persist_base_valid;
+    if (persist_base_valid) {
+        diff_shard_pages(job, persist_base.student_pages, persist_base.student_page_count,
+                         gen->student_pages, gen->student_page_count,
+                         sizeof(Student), offsetof(Student, hostel_block));
+        diff_shard_pages(job, persist_base.ticket_pages, persist_base.ticket_page_count,
+                         gen->ticket_pages, gen->ticket_page_count,
+                         sizeof(Ticket), offsetof(Ticket, hostel_block));
+    }
+
+    /* WITHOUT A BASE THE NEXT JOB REWRITES EVERY SHARD */
+    release_generation(&persist_base);
+    persist_base_valid = copy_generation(&persist_base, gen);
+}
+
+/* A RECORD THAT CHANGED, APPEARED OR DISAPPEARED AT A POSITION DIRTIES THE SHARDS OF
+   BOTH ITS OLD AND NEW VERSION, WHICH ALSO COVERS A STUDENT MOVING BLOCK */
+void diff_shard_pages(PersistJob *job, SnapshotPage **old_pages, int old_count,
+                      SnapshotPage **new_pages, int new_count, size_t record_size, size_t block_offset) {
+    int pages = old_count > new_count ? old_count : new_count;
+
+    for (int p = 0; p < pages && !job->all_shards_dirty; p++) {
+        SnapshotPage *old_page = p < old_count ? old_pages[p] : NULL;
+        SnapshotPage *new_page = p < new_count ? new_pages[p] : NULL;
+        if (old_page == new_page) continue;
+
+        for (int r = 0; r < PAGE_RECORDS; r++) {
+            const unsigned char *old_rec = old_page != NULL && r < old_page->records ? old_page->data + r * record_size : NULL;
+            const unsigned char *new_rec = new_page != NULL && r < new_page->records ? new_page->data + r * record_size : NULL;
+            if (old_rec == NULL && new_rec == NULL) break;
+            if (old_rec != NULL && new_rec != NULL && memcmp(old_rec, new_rec, record_size) == 0) continue;
+            if (old_rec != NULL) add_dirty_shard(job, (const char *)old_rec + block_offset);
+            if (new_rec != NULL) add_dirty_shard(job, (const char *)new_rec + block_offset);
+        }
+    }
+}
+
+void add_dirty_shard(PersistJob *job, const char *hostel_block) {
+    char key[SHARD_KEY_SIZE];
+    shard_key(hostel_block, key);
+    if (shard_slot(job->dirty_shards, &job->dirty_shard_count, key, 0) != -1) return;
+    if (job->dirty_shard_count == MAX_SHARDS) {
+        job->all_shards_dirty = 1;
         return;
     }
-    printf("\nALL ISSUES / TICKETS\n");
-    print_line();
-    printf("| TID | STU_ID | STUDENT NAME        | STATUS       |\n");
-    print_line();
+    shard_slot(job->dirty_shards, &job->dirty_shard_count, key, 1);
+}
+
+/* A PENDING JOB REPLACED BEFORE IT WAS WRITTEN PASSES ITS DIRTY SHARDS ON */
+void merge_dirty_shards(PersistJob *job, PersistJob *older) {
+    if (older->all_shards_dirty) job->all_shards_dirty = 1;
+    for (int d = 0; d < older->dirty_shard_count; d++) {
+        add_dirty_shard(job, older->dirty_shards[d]);
+    }
+}
+
+/* WRITES ONE SHARD'S RECORDS FROM A GENERATION: THOSE WHOSE order ENTRY IS shard,
+   FOLLOWED BY THEIR POSITIONS IN THE WHOLE ARRAY. A SHARD WITH NO RECORDS OF THIS KIND
+   HAS NO FILE */
+int write_shard_file(const char *path, const void *header, size_t header_size,
+                     SnapshotPage **pages, int page_count, size_t record_size,
+                     const unsigned char *order, int shard, int count) {
+    char tmp_path[64];
+    int ok, n = 0;
+    FILE *fp;
+
+    if (count == 0) {
+        remove(path);
+        return 1;
+    }
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL) return 0;
+
+    ok = fwrite(header, header_size, 1, fp) == 1;
+    for (int p = 0; ok && p < page_count; p++) {
+        for (int r = 0; ok && r < pages[p]->records; r++) {
+            if (order[n++] != shard) continue;
+            ok = fwrite(pages[p]->data + r * record_size, record_size, 1, fp) == 1;
+        }
+    }
+    for (int i = 0; ok && i < n; i++) {
+        if (order[i] == shard) ok = fwrite(&i, sizeof(int), 1, fp) == 1;
+    }
+    ok = fclose(fp) == 0 && ok;
+    if (!ok) {
+        remove(tmp_path);
+        return 0;
+    }
+    return replace_file(tmp_path, path);
+}
+
+/* WRITER THREAD: REWRITES THE FILES OF DIRTY SHARDS AND OF SHARDS NOT ON DISK YET,
+   THEN shards.dat, THEN REMOVES FILES OF SHARDS THAT NO LONGER HAVE RECORDS */
+int write_shard_files(PersistJob *job) {
+    Snapshot *gen = &job->generation;
+    char keys[MAX_SHARDS][SHARD_KEY_SIZE];
+    char key[SHARD_KEY_SIZE], path[64];
+    int students_in[MAX_SHARDS], tickets_in[MAX_SHARDS];
+    unsigned char dirty[MAX_SHARDS];
+    unsigned char *student_order, *ticket_order;
+    ShardFileHeader header;
+    TicketFileHeader ticket_header;
+    int count = 0, ok = 1, n;
+
+    /* THE SHARD OF EVERY RECORD, IN ARRAY ORDER */
+    student_order = malloc(gen->student_count + gen->ticket_count + 1);
+    if (student_order == NULL) {
+        rewrite_all_shards = 1;
+        return 0;
+    }
+    ticket_order = student_order + gen->student_count;
+    memset(keys, 0, sizeof(keys));          // NO STACK BYTES AFTER THE KEYS IN shards.dat
+    memset(students_in, 0, sizeof(students_in));
+    memset(tickets_in, 0, sizeof(tickets_in));
+
+    n = 0;
+    for (int p = 0; p < gen->student_page_count; p++) {
+        for (int r = 0; r < gen->student_pages[p]->records; r++) {
+            shard_key(((Student *)gen->student_pages[p]->data)[r].hostel_block, key);
+            student_order[n] = (unsigned char)shard_slot(keys, &count, key, 1);
+            students_in[student_order[n++]]++;
+        }
+    }
+    n = 0;
+    for (int p = 0; p < gen->ticket_page_count; p++) {
+        for (int r = 0; r < gen->ticket_pages[p]->records; r++) {
+            shard_key(((Ticket *)gen->ticket_pages[p]->data)[r].hostel_block, key);
+            ticket_order[n] = (unsigned char)shard_slot(keys, &count, key, 1);
+            tickets_in[ticket_order[n++]]++;
+        }
+    }
+
+    memset(dirty, job->all_shards_dirty || rewrite_all_shards, sizeof(dirty));
+    for (int d = 0; d < job->dirty_shard_count; d++) {
+        int s = shard_slot(keys, &count, job->dirty_shards[d], 0);
+        if (s != -1) dirty[s] = 1;
+        else if (count == MAX_SHARDS) dirty[MAX_SHARDS - 1] = 1;    // MAY LIVE IN THE LAST SHARD
+    }
+
+    ticket_header.magic = TICKET_FILE_MAGIC;
+    ticket_header.version = TICKET_FILE_VERSION;
+    ticket_header.next_ticket_id = gen->next_ticket_id;
+    for (int s = 0; s < count; s++) {
+        if (!dirty[s] && shard_slot(written_shards, &written_shard_count, keys[s], 0) != -1) continue;
+
+        shard_file_name(path, sizeof(path), SHARD_STUDENT_FILE, keys[s]);
+        ok = write_shard_file(path, &students_in[s], sizeof(int), gen->student_pages, gen->student_page_count,
+                              sizeof(Student), student_order, s, students_in[s]) && ok;
+        ticket_header.count = tickets_in[s];
+        shard_file_name(path, sizeof(path), SHARD_TICKET_FILE, keys[s]);
+        ok = write_shard_file(path, &ticket_header, sizeof(ticket_header), gen->ticket_pages, gen->ticket_page_count,
+                              sizeof(Ticket), ticket_order, s, tickets_in[s]) && ok;
+    }
+
+    /* shards.dat (HEADER AND KEYS ONLY) IS REPLACED ONCE EVERY SHARD IT NAMES HAS BEEN WRITTEN */
+    free(student_order);
+    if (ok) {
+        header.magic = SHARD_MAGIC;
+        header.version = SHARD_VERSION;
+        header.generation = data_generation + 1;
+        header.shard_count = count;
+        header.student_count = gen->student_count;
+        header.ticket_count = gen->ticket_count;
+        header.next_ticket_id = gen->next_ticket_id;
+        ok = write_file_replace(SHARD_FILE, &header, sizeof(header), keys, SHARD_KEY_SIZE, count);
+    }
+
+    if (!ok) {
+        rewrite_all_shards = 1;
+        return 0;
+    }
+    rewrite_all_shards = 0;
+    data_generation = header.generation;
+    write_index_file(gen, data_generation);
+
+    for (int w = 0; w < written_shard_count; w++) {
+        if (shard_slot(keys, &count, written_shards[w], 0) != -1) continue;
+        shard_file_name(path, sizeof(path), SHARD_STUDENT_FILE, written_shards[w]);
+        remove(path);
+        shard_file_name(path, sizeof(path), SHARD_TICKET_FILE, written_shards[w]);
+        remove(path);
+    }
+    memcpy(written_shards, keys, count * SHARD_KEY_SIZE);
+    written_shard_count = count;
+
+    /* THE SINGLE FILES OF OLDER VERSIONS ARE NOW FULLY COVERED BY THE SHARDS */
+    if (legacy_files_present) {
+        remove(STUDENT_FILE);
+        remove(TICKET_FILE);
+        legacy_files_present = 0;
+    }
+    return 1;
+}
+
+void remove_shard_files() {
+    char path[64];
+    for (int w = 0; w < written_shard_count; w++) {
+        shard_file_name(path, sizeof(path), SHARD_STUDENT_FILE, written_shards[w]);
+        remove(path);
+        shard_file_name(path, sizeof(path), SHARD_TICKET_FILE, written_shards[w]);
+        remove(path);
+    }
+    written_shard_count = 0;
+    remove(SHARD_FILE);
+    remove(INDEX_FILE);
+}
+
+/* COUNTING SORT OF RECORD POSITIONS BY SHARD, SO A SHARD'S RECORDS ARE ONE RANGE */
+void rebuild_shard_index() {
+    static unsigned char student_slot[MAX_STUDENTS];
+    static unsigned char ticket_slot[MAX_TICKETS];
+    char keys[MAX_SHARDS][SHARD_KEY_SIZE];
+    char key[SHARD_KEY_SIZE];
+    int count = 0, next_student = 0, next_ticket = 0;
+
+    if (!shard_index_stale) return;
+
+    memset(shards, 0, sizeof(shards));
+    for (int i = 0; i < student_count; i++) {
+        shard_key(students[i].hostel_block, key);
+        student_slot[i] = (unsigned char)shard_slot(keys, &count, key, 1);
+        shards[student_slot[i]].student_count++;
+    }
     for (int i = 0; i < ticket_count; i++) {
-        printf("| %-3d | %-6d | %-18s | %-11s |\n",
-               tickets[i].ticket_id,
-               tickets[i].student_id,
-               tickets[i].student_name,
-               tickets[i].status);
+        shard_key(tickets[i].hostel_block, key);
+        ticket_slot[i] = (unsigned char)shard_slot(keys, &count, key, 1);
+        shards[ticket_slot[i]].ticket_count++;
     }
-    print_line();
+
+    for (int s = 0; s < count; s++) {
+        strcpy(shards[s].key, keys[s]);
+        shards[s].first_student = next_student;
+        shards[s].first_ticket = next_ticket;
+        next_student += shards[s].student_count;
+        next_ticket += shards[s].ticket_count;
+        shards[s].student_count = 0;
+        shards[s].ticket_count = 0;
+    }
+    for (int i = 0; i < student_count; i++) {
+        Shard *shard = &shards[student_slot[i]];
+        shard_student_pos[shard->first_student + shard->student_count++] = i;
+    }
+    for (int i = 0; i < ticket_count; i++) {
+        Shard *shard = &shards[ticket_slot[i]];
+        shard_ticket_pos[shard->first_ticket + shard->ticket_count++] = i;
+    }
+    shard_count = count;
+    shard_index_stale = 0;
 }
 
-void view_open_tickets() {
-    int found = 0;
-    printf("\nOPEN ISSUES ONLY\n");
-    print_line();
-    printf("| TID | STU_ID | STUDENT NAME        | STATUS |\n");
-    print_line();
+/* ONE SHARD'S PART OF THE DASHBOARD, READ THROUGH ITS OWN INDEX RANGE */
+void summarize_shard(int s, ShardSummary *out) {
+    memset(out, 0, sizeof(ShardSummary));
+    for (int k = 0; k < shards[s].student_count; k++) {
+        Student *st = &students[shard_student_pos[shards[s].first_student + k]];
+        out->students++;
+        if (st->is_active) out->active++;
+        if (strcmp(st->campus, "A") == 0) out->campus_a++;
+        if (strcmp(st->campus, "B") == 0) out->campus_b++;
+    }
+    for (int k = 0; k < shards[s].ticket_count; k++) {
+        Ticket *t = &tickets[shard_ticket_pos[shards[s].first_ticket + k]];
+        out->tickets++;
+        if (strcmp(t->status, "OPEN") == 0) out->open_issues++;
+    }
+}
+
+/* --------------------- RECORD INDEXES --------------------- */
+
+void note_records_moved() {
+    student_index_stale = 1;
+    ticket_index_stale = 1;
+    name_index_stale = 1;
+}
+
+void ensure_record_indexes() {
+    if (student_index_stale || ticket_index_stale || name_index_stale) {
+        rebuild_record_indexes();
+    }
+}
+
+/* REBUILDS THE STALE INDEXES. THE FOUR BUILDS ARE INDEPENDENT, SO A LARGE STORE
+   GETS ONE THREAD EACH; A THREAD THAT CANNOT START IS RUN HERE INSTEAD */
+void rebuild_record_indexes() {
+    void (*builders[4])(void *);
+    hms_thread threads[4];
+    int started[4];
+    int count = 0;
+    int parallel = student_count + ticket_count >= PARALLEL_REBUILD_MIN;
+    int names = name_index_stale || student_index_stale;
+
+    if (student_index_stale) builders[count++] = build_student_id_index;
+    if (ticket_index_stale) {
+        builders[count++] = build_ticket_id_index;
+        builders[count++] = build_ticket_owner_index;
+    }
+    if (names) builders[count++] = build_name_index;
+    student_index_stale = 0;
+    ticket_index_stale = 0;
+    if (names) name_index_stale = 0;    // build_name_index() SETS IT AGAIN IF IT RUNS OUT OF MEMORY
+
+    for (int b = 1; b < count; b++) {
+        started[b] = parallel && hms_thread_start(&threads[b], builders[b], NULL);
+        if (!started[b]) builders[b](NULL);
+    }
+    if (count > 0) builders[0](NULL);
+    for (int b = 1; b < count; b++) {
+        if (started[b]) hms_thread_join(threads[b]);
+    }
+}
+
+/* ORDER BY KEY, THEN BY POSITION, SO THE FIRST OF TWO EQUAL KEYS IS THE EARLIER RECORD */
+int compare_index_entries(const void *a, const void *b) {
+    const IndexEntry *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+/* MATCHES ARE LISTED BY NAME, THEN BY POSITION */
+int compare_student_names(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    int cmp = strcmp(students[x].name, students[y].name);
+    if (cmp != 0) return cmp;
+    return (x > y) - (x < y);
+}
+
+void build_student_id_index(void *unused) {
+    (void)unused;
+    for (int i = 0; i < student_count; i++) {
+        student_id_index[i].key = students[i].id;
+        student_id_index[i].pos = i;
+    }
+    qsort(student_id_index, student_count, sizeof(IndexEntry), compare_index_entries);
+}
+
+/* TICKET IDS ARE HANDED OUT IN ORDER, SO THIS IS USUALLY SORTED ALREADY */
+void build_ticket_id_index(void *unused) {
+    int sorted = 1;
+    (void)unused;
     for (int i = 0; i < ticket_count; i++) {
-        if (strcmp(tickets[i].status, "OPEN") == 0) {
-            printf("| %-3d | %-6d | %-18s | %-6s |\n",
-                   tickets[i].ticket_id,
-                   tickets[i].student_id,
-                   tickets[i].student_name,
-                   tickets[i].status);
-            found = 1;
-        }
+        ticket_id_index[i].key = tickets[i].ticket_id;
+        ticket_id_index[i].pos = i;
+        if (i > 0 && ticket_id_index[i].key <= ticket_id_index[i - 1].key) sorted = 0;
     }
-    print_line();
-    if (!found) {
-        printf("\nNO OPEN ISSUES.\n");
+    if (!sorted) qsort(ticket_id_index, ticket_count, sizeof(IndexEntry), compare_index_entries);
+}
+
+void build_ticket_owner_index(void *unused) {
+    (void)unused;
+    for (int i = 0; i < ticket_count; i++) {
+        ticket_owner_index[i].key = tickets[i].student_id;
+        ticket_owner_index[i].pos = i;
     }
+    qsort(ticket_owner_index, ticket_count, sizeof(IndexEntry), compare_index_entries);
 }
 
-void update_ticket_status() {
-    int tid, index, choice;
-    printf("\nUPDATE ISSUE STATUS (ADMIN ONLY)\n");
-    tid = read_int("ENTER TICKET ID: ");
-    index = find_ticket_by_id(tid);
+/* THE DISTINCT BUCKETS OF THE 3-CHARACTER PIECES OF name. ANY TEXT THE NAME CONTAINS
+   HAS ALL ITS OWN PIECES AMONG THEM */
+int name_grams(const char *name, int *buckets) {
+    const unsigned char *c = (const unsigned char *)name;
+    int count = 0;
+    for (int i = 0; c[i] != '\0' && c[i + 1] != '\0' && c[i + 2] != '\0'; i++) {
+        unsigned int key = (unsigned int)c[i] << 16 | (unsigned int)c[i + 1] << 8 | c[i + 2];
+        int b = (int)((key * 2654435761u) >> (32 - NAME_GRAM_BITS)), seen = 0;
+        for (int k = 0; k < count && !seen; k++) seen = buckets[k] == b;
+        if (!seen) buckets[count++] = b;
+    }
+    return count;
+}
 
-    if (index == -1) {
-        printf("\nTICKET NOT FOUND.\n");
+const char *live_name(int pos) {
+    return students[pos].name;
+}
+
+/* COUNTS THE PIECES OF EVERY NAME PER BUCKET, THEN FILLS THE BUCKETS IN POSITION ORDER.
+   starts HAS NAME_GRAM_BUCKETS + 1 ENTRIES. RETURNS 0 IF *positions CANNOT BE ALLOCATED */
+int build_name_grams(const char *(*name_at)(int pos), int count, int *starts, int **positions) {
+    int buckets[sizeof(((Student *)0)->name)];
+
+    memset(starts, 0, (NAME_GRAM_BUCKETS + 1) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        int n = name_grams(name_at(i), buckets);
+        for (int k = 0; k < n; k++) starts[buckets[k] + 1]++;
+    }
+    for (int b = 0; b < NAME_GRAM_BUCKETS; b++) starts[b + 1] += starts[b];
+
+    *positions = malloc(starts[NAME_GRAM_BUCKETS] * sizeof(int) + 1);
+    if (*positions == NULL) return 0;
+    /* starts[b] IS USED AS BUCKET b'S WRITE CURSOR AND ENDS AT THE START OF b + 1 */
+    for (int i = 0; i < count; i++) {
+        int n = name_grams(name_at(i), buckets);
+        for (int k = 0; k < n; k++) (*positions)[starts[buckets[k]]++] = i;
+    }
+    memmove(starts + 1, starts, NAME_GRAM_BUCKETS * sizeof(int));
+    starts[0] = 0;
+    return 1;
+}
+
+void build_name_index(void *unused) {
+    int *positions;
+    (void)unused;
+    free(name_gram_pos);
+    name_gram_pos = NULL;
+    name_gram_students = 0;
+    if (!build_name_grams(live_name, student_count, name_gram_start, &positions)) {
+        name_index_stale = 1;
         return;
     }
+    name_gram_pos = positions;
+    name_gram_students = student_count;
+}
 
-    printf("\nCURRENT STATUS: %s\n", tickets[index].status);
-    printf("1. SET STATUS TO OPEN\n");
-    printf("2. SET STATUS TO IN_PROGRESS\n");
-    printf("3. SET STATUS TO RESOLVED\n");
-    printf("0. CANCEL\n");
+/* POSITIONS OF THE STUDENTS WHOSE NAME CONTAINS text, IN NO PARTICULAR ORDER. ONLY THE
+   SMALLEST BUCKET AMONG THE PIECES OF text IS CHECKED, PLUS STUDENTS ADDED SINCE THE
+   BUILD; TEXT SHORTER THAN ONE PIECE IS CHECKED AGAINST EVERY NAME */
+int find_name_matches(const char *text, int *matches) {
+    int buckets[sizeof(((Student *)0)->name)];
+    int n = name_grams(text, buckets), count = 0, from = 0;
 
-    choice = read_int("ENTER CHOICE: ");
-    switch (choice) {
-        case 1: strcpy(tickets[index].status, "OPEN"); break;
-        case 2: strcpy(tickets[index].status, "IN_PROGRESS"); break;
-        case 3: strcpy(tickets[index].status, "RESOLVED"); break;
-        case 0: printf("\nNO CHANGE MADE.\n"); return;
-        default: printf("\nINVALID OPTION.\n"); return;
+    if (n > 0 && name_gram_students > 0) {
+        int best = buckets[0];
+        for (int k = 1; k < n; k++) {
+            if (name_gram_start[buckets[k] + 1] - name_gram_start[buckets[k]] <
+                name_gram_start[best + 1] - name_gram_start[best]) {
+                best = buckets[k];
+            }
+        }
+        for (int e = name_gram_start[best]; e < name_gram_start[best + 1]; e++) {
+            int pos = name_gram_pos[e];
+            if (pos < student_count && strstr(students[pos].name, text) != NULL) matches[count++] = pos;
+        }
+        from = name_gram_students;
     }
-    printf("\nTICKET STATUS UPDATED SUCCESSFULLY.\n");
+    for (int i = from; i < student_count; i++) {
+        if (strstr(students[i].name, text) != NULL) matches[count++] = i;
+    }
+    return count;
 }
 
-/* ---------------------- INPUT HELPERS ---------------------- */
+/* FIRST ENTRY WHOSE KEY IS AT LEAST key */
+int index_lower_bound(IndexEntry *index, int count, int key) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (index[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
 
-void clear_input_buffer() {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF) {}
+/* count = ENTRIES BEFORE THE INSERT; THE ARRAY MUST HAVE ROOM FOR ONE MORE */
+void index_insert(IndexEntry *index, int count, int key, int pos) {
+    IndexEntry entry;
+    int lo = 0, hi = count;
+
+    entry.key = key;
+    entry.pos = pos;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (compare_index_entries(&index[mid], &entry) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&index[lo + 1], &index[lo], (count - lo) * sizeof(IndexEntry));
+    index[lo] = entry;
 }
 
-void read_string(char *prompt, char *buffer, int size) {
-    printf("%s", prompt);
-    fgets(buffer, size, stdin);
-    /* REMOVE NEWLINE */
-    size_t len = strlen(buffer);
-    if (len > 0 && buffer[len - 1] == '\n') {
-        buffer[len - 1] = '\0';
+/* CALLED ONCE A STUDENT HAS BEEN APPENDED AT pos */
+void index_add_student(int pos) {
+    if (!student_index_stale) {
+        index_insert(student_id_index, pos, students[pos].id, pos);
     }
+    /* THE NAME INDEX IS LEFT ALONE: SEARCHES CHECK STUDENTS PAST name_gram_students DIRECTLY */
 }
 
-int read_int(char *prompt) {
-    int value;
-    printf("%s", prompt);
-    while (scanf("%d", &value) != 1) {
-        clear_input_buffer();
-        printf("INVALID INPUT. ENTER INTEGER VALUE: ");
+void index_add_ticket(int pos) {
+    if (!ticket_index_stale) {
+        index_insert(ticket_id_index, pos, tickets[pos].ticket_id, pos);
+        index_insert(ticket_owner_index, pos, tickets[pos].student_id, pos);
+    }
+}
+
+/* AFTER A LOAD: OF SEVERAL RECORDS WITH ONE ID THE FIRST IN ARRAY ORDER STAYS.
+   RETURNS THE NUMBER DROPPED */
+int drop_duplicate_ids() {
+    unsigned char *drop_student = calloc(student_count + 1, 1);
+    unsigned char *drop_ticket = calloc(ticket_count + 1, 1);
+    int dropped = 0, kept;
+
+    if (drop_student == NULL || drop_ticket == NULL) {
+        free(drop_student);
+        free(drop_ticket);
+        return 0;
     }
-    clear_input_buffer();
-    return value;
+    for (int e = 1; e < student_count; e++) {
+        if (student_id_index[e].key == student_id_index[e - 1].key) {
+            drop_student[student_id_index[e].pos] = 1;
+            dropped++;
+        }
+    }
+    for (int e = 1; e < ticket_count; e++) {
+        if (ticket_id_index[e].key == ticket_id_index[e - 1].key) {
+            drop_ticket[ticket_id_index[e].pos] = 1;
+            dropped++;
+        }
+    }
+
+    if (dropped > 0) {
+        kept = 0;
+        for (int i = 0; i < student_count; i++) {
+            if (!drop_student[i]) students[kept++] = students[i];
+        }
+        student_count = kept;
+        kept = 0;
+        for (int i = 0; i < ticket_count; i++) {
+            if (!drop_ticket[i]) tickets[kept++] = tickets[i];
+        }
+        ticket_count = kept;
+        note_records_moved();
+        ensure_record_indexes();
+    }
+    free(drop_student);
+    free(drop_ticket);
+    return dropped;
+}
+
+/* ONE PASS OVER THE STORES: EVERY INDEX MUST LIST EACH RECORD EXACTLY ONCE, UNDER ITS
+   OWN KEY, IN ORDER. USED BY THE SELF CHECKS, WHICH ALSO RUN IT ON EVERY indexes.dat READ */
+const char *validate_record_indexes() {
+    int buckets[sizeof(((Student *)0)->name)];
+    int expected_grams = 0;
+
+    for (int e = 0; e < student_count; e++) {
+        IndexEntry *x = &student_id_index[e];
+        if (x->pos < 0 || x->pos >= student_count || students[x->pos].id != x->key) return "STUDENT ID INDEX ENTRY WRONG";
+        if (e > 0 && student_id_index[e - 1].key >= x->key) return "STUDENT ID INDEX OUT OF ORDER";
+    }
+    for (int e = 0; e < ticket_count; e++) {
+        IndexEntry *x = &ticket_id_index[e];
+        IndexEntry *o = &ticket_owner_index[e];
+        if (x->pos < 0 || x->pos >= ticket_count || tickets[x->pos].ticket_id != x->key) return "TICKET ID INDEX ENTRY WRONG";
+        if (e > 0 && ticket_id_index[e - 1].key >= x->key) return "TICKET ID INDEX OUT OF ORDER";
+        if (o->pos < 0 || o->pos >= ticket_count || tickets[o->pos].student_id != o->key) return "ISSUE OWNER INDEX ENTRY WRONG";
+        if (e > 0 && compare_index_entries(&ticket_owner_index[e - 1], o) >= 0) return "ISSUE OWNER INDEX OUT OF ORDER";
+    }
+
+    /* NAME PIECES: EVERY PIECE OF EVERY INDEXED NAME IS IN ITS BUCKET, AND NOTHING ELSE IS */
+    if (name_gram_students < 0 || name_gram_students > student_count) return "NAME INDEX SIZE WRONG";
+    if (name_gram_students == 0) return NULL;
+    for (int b = 0; b < NAME_GRAM_BUCKETS; b++) {
+        if (name_gram_start[b] > name_gram_start[b + 1]) return "NAME INDEX BUCKETS OUT OF ORDER";
+        for (int e = name_gram_start[b]; e < name_gram_start[b + 1]; e++) {
+            if (name_gram_pos[e] < 0 || name_gram_pos[e] >= name_gram_students ||
+                (e > name_gram_start[b] && name_gram_pos[e - 1] >= name_gram_pos[e])) {
+                return "NAME INDEX ENTRY WRONG";
+            }
+        }
+    }
+    for (int i = 0; i < name_gram_students; i++) {
+        int n = name_grams(students[i].name, buckets);
+        expected_grams += n;
+        for (int k = 0; k < n; k++) {
+            int lo = name_gram_start[buckets[k]], hi = name_gram_start[buckets[k] + 1];
+            while (lo < hi) {
+                int mid = lo + (hi - lo) / 2;
+                if (name_gram_pos[mid] < i) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo == name_gram_start[buckets[k] + 1] || name_gram_pos[lo] != i) return "NAME MISSING FROM NAME INDEX";
+        }
+    }
+    if (name_gram_start[0] != 0 || name_gram_start[NAME_GRAM_BUCKETS] != expected_grams) return "NAME INDEX SIZE WRONG";
+    return NULL;
+}
+
+/* THREAD BODY: READS indexes.dat WHILE THE SHARD THREADS READ THE RECORDS */
+void load_index_file(void *arg) {
+    IndexLoad *load = arg;
+    IndexFileHeader *h = &load->header;
+    FILE *fp = fopen(INDEX_FILE, "rb");
+
+    if (fp == NULL) return;
+    if (fread(h, sizeof(IndexFileHeader), 1, fp) == 1 && h->magic == INDEX_MAGIC && h->version == INDEX_VERSION &&
+        h->student_count >= 0 && h->student_count <= MAX_STUDENTS &&
+        h->ticket_count >= 0 && h->ticket_count <= MAX_TICKETS &&
+        h->gram_count >= 0 && h->gram_count <= h->student_count * (int)(sizeof(students[0].name) - 3)) {
+        load->student_ids = malloc(h->student_count * sizeof(IndexEntry) + 1);
+        load->ticket_ids = malloc(h->ticket_count * sizeof(IndexEntry) + 1);
+        load->ticket_owners = malloc(h->ticket_count * sizeof(IndexEntry) + 1);
+        load->gram_start = malloc((NAME_GRAM_BUCKETS + 1) * sizeof(int));
+        load->gram_pos = malloc(h->gram_count * sizeof(int) + 1);
+        load->complete = load->student_ids != NULL && load->ticket_ids != NULL && load->ticket_owners != NULL &&
+                         load->gram_start != NULL && load->gram_pos != NULL &&
+                         fread(load->student_ids, sizeof(IndexEntry), h->student_count, fp) == (size_t)h->student_count &&
+                         fread(load->ticket_ids, sizeof(IndexEntry), h->ticket_count, fp) == (size_t)h->ticket_count &&
+                         fread(load->ticket_owners, sizeof(IndexEntry), h->ticket_count, fp) == (size_t)h->ticket_count &&
+                         fread(load->gram_start, sizeof(int), NAME_GRAM_BUCKETS + 1, fp) == NAME_GRAM_BUCKETS + 1 &&
+                         fread(load->gram_pos, sizeof(int), h->gram_count, fp) == (size_t)h->gram_count;
+    }
+    fclose(fp);
+    if (!load->complete) return;
+
+    /* STILL ON THIS THREAD, SO IT OVERLAPS THE SHARD READS: THE FILE MUST BE AS WRITTEN,
+       AND NO POSITION IN IT MAY POINT OUTSIDE THE ARRAYS */
+    load->complete = index_file_checksum(h, load->student_ids, load->ticket_ids, load->ticket_owners,
+                                         load->gram_start, load->gram_pos) == h->checksum &&
+                     index_positions_valid(load->student_ids, h->student_count, h->student_count) &&
+                     index_positions_valid(load->ticket_ids, h->ticket_count, h->ticket_count) &&
+                     index_positions_valid(load->ticket_owners, h->ticket_count, h->ticket_count) &&
+                     load->gram_start[0] == 0 && load->gram_start[NAME_GRAM_BUCKETS] == h->gram_count;
+    for (int b = 0; b < NAME_GRAM_BUCKETS && load->complete; b++) {
+        if (load->gram_start[b] > load->gram_start[b + 1]) load->complete = 0;
+    }
+    for (int e = 0; e < h->gram_count && load->complete; e++) {
+        if (load->gram_pos[e] < 0 || load->gram_pos[e] >= h->student_count) load->complete = 0;
+    }
+}
+
+/* FNV-1a OVER 32-BIT WORDS, CHAINED FROM ONE ARRAY OF indexes.dat TO THE NEXT */
+unsigned int index_checksum(unsigned int sum, const int *words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sum = (sum ^ (unsigned int)words[i]) * 16777619u;
+    }
+    return sum;
+}
+
+/* THE header.checksum OF indexes.dat; THE COUNTS COME FROM THE HEADER */
+unsigned int index_file_checksum(const IndexFileHeader *h, const IndexEntry *student_ids, const IndexEntry *ticket_ids,
+                                 const IndexEntry *ticket_owners, const int *gram_start, const int *gram_pos) {
+    unsigned int sum = INDEX_CHECKSUM_SEED;
+
+    sum = index_checksum(sum, (const int *)student_ids, (size_t)h->student_count * 2);
+    sum = index_checksum(sum, (const int *)ticket_ids, (size_t)h->ticket_count * 2);
+    sum = index_checksum(sum, (const int *)ticket_owners, (size_t)h->ticket_count * 2);
+    sum = index_checksum(sum, gram_start, NAME_GRAM_BUCKETS + 1);
+    return index_checksum(sum, gram_pos, h->gram_count);
+}
+
+int index_positions_valid(const IndexEntry *index, int count, int limit) {
+    for (int e = 0; e < count; e++) {
+        if (index[e].pos < 0 || index[e].pos >= limit) return 0;
+    }
+    return 1;
+}
+
+/* TAKES OVER THE LOADED INDEXES IF THEY FIT THE RECORDS JUST LOADED. RETURNS 1 IF USED.
+   A MATCHING GENERATION AND CHECKSUM ARE TRUSTED; ONLY THE SELF TEST AND FUZZ BUILDS ALSO
+   CHECK EVERY ENTRY AGAINST THE RECORDS */
+int adopt_index_file(IndexLoad *load) {
+    if (!load->complete || load->header.student_count != student_count ||
+        load->header.ticket_count != ticket_count) {
+        return 0;
+    }
+    memcpy(student_id_index, load->student_ids, student_count * sizeof(IndexEntry));
+    memcpy(ticket_id_index, load->ticket_ids, ticket_count * sizeof(IndexEntry));
+    memcpy(ticket_owner_index, load->ticket_owners, ticket_count * sizeof(IndexEntry));
+    memcpy(name_gram_start, load->gram_start, sizeof(name_gram_start));
+    free(name_gram_pos);
+    name_gram_pos = load->gram_pos;
+    name_gram_students = student_count;
+    load->gram_pos = NULL;
+
+#if defined(HMS_SELFTEST) || defined(HMS_FUZZ)
+    if (validate_record_indexes() != NULL) {
+        note_records_moved();
+        return 0;
+    }
+#endif
+    student_index_stale = 0;
+    ticket_index_stale = 0;
+    name_index_stale = 0;
+    return 1;
+}
+
+/* WRITER THREAD: NAMES ARE READ FROM THE GENERATION BEING SAVED, NOT THE LIVE STORE */
+const char *generation_name(int pos) {
+    return ((Student *)index_generation->student_pages[pos / PAGE_RECORDS]->data)[pos % PAGE_RECORDS].name;
+}
+
+/* FILLS, SORTS AND WRITES THE INDEX ARRAYS FOR write_index_file() */
+int write_index_arrays(Snapshot *gen, int generation, IndexEntry *student_ids, IndexEntry *ticket_ids,
+                       IndexEntry *ticket_owners, int *gram_start) {
+    IndexFileHeader header;
+    int *gram_pos;
+    int n = 0, ok;
+    char tmp_path[64];
+    FILE *fp;
+
+    for (int p = 0; p < gen->student_page_count; p++) {
+        Student *page = (Student *)gen->student_pages[p]->data;
+        for (int r = 0; r < gen->student_pages[p]->records; r++, n++) {
+            student_ids[n].key = page[r].id;
+            student_ids[n].pos = n;
+        }
+    }
+    n = 0;
+    for (int p = 0; p < gen->ticket_page_count; p++) {
+        Ticket *page = (Ticket *)gen->ticket_pages[p]->data;
+        for (int r = 0; r < gen->ticket_pages[p]->records; r++, n++) {
+            ticket_ids[n].key = page[r].ticket_id;
+            ticket_ids[n].pos = n;
+            ticket_owners[n].key = page[r].student_id;
+            ticket_owners[n].pos = n;
+        }
+    }
+    qsort(student_ids, gen->student_count, sizeof(IndexEntry), compare_index_entries);
+    qsort(ticket_ids, gen->ticket_count, sizeof(IndexEntry), compare_index_entries);
+    qsort(ticket_owners, gen->ticket_count, sizeof(IndexEntry), compare_index_entries);
+    index_generation = gen;
+    if (!build_name_grams(generation_name, gen->student_count, gram_start, &gram_pos)) return 0;
+
+    header.magic = INDEX_MAGIC;
+    header.version = INDEX_VERSION;
+    header.generation = generation;
+    header.student_count = gen->student_count;
+    header.ticket_count = gen->ticket_count;
+    header.gram_count = gram_start[NAME_GRAM_BUCKETS];
+    header.checksum = index_file_checksum(&header, student_ids, ticket_ids, ticket_owners, gram_start, gram_pos);
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", INDEX_FILE);
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        free(gram_pos);
+        return 0;
+    }
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(student_ids, sizeof(IndexEntry), gen->student_count, fp) == (size_t)gen->student_count &&
+         fwrite(ticket_ids, sizeof(IndexEntry), gen->ticket_count, fp) == (size_t)gen->ticket_count &&
+         fwrite(ticket_owners, sizeof(IndexEntry), gen->ticket_count, fp) == (size_t)gen->ticket_count &&
+         fwrite(gram_start, sizeof(int), NAME_GRAM_BUCKETS + 1, fp) == NAME_GRAM_BUCKETS + 1 &&
+         fwrite(gram_pos, sizeof(int), header.gram_count, fp) == (size_t)header.gram_count;
+    ok = fclose(fp) == 0 && ok;
+    free(gram_pos);
+    if (!ok) {
+        remove(tmp_path);
+        return 0;
+    }
+    return replace_file(tmp_path, INDEX_FILE);
+}
+
+/* WRITER THREAD: BUILDS ALL FOUR INDEXES FOR A SAVED GENERATION AND WRITES THEM WITH ITS
+   GENERATION STAMP. A FAILED WRITE ONLY MEANS THE NEXT START REBUILDS THEM */
+int write_index_file(Snapshot *gen, int generation) {
+    IndexEntry *student_ids = malloc(gen->student_count * sizeof(IndexEntry) + 1);
+    IndexEntry *ticket_ids = malloc(gen->ticket_count * sizeof(IndexEntry) + 1);
+    IndexEntry *ticket_owners = malloc(gen->ticket_count * sizeof(IndexEntry) + 1);
+    int *gram_start = malloc((NAME_GRAM_BUCKETS + 1) * sizeof(int));
+    int ok = 0;
+
+    if (student_ids != NULL && ticket_ids != NULL && ticket_owners != NULL && gram_start != NULL) {
+        ok = write_index_arrays(gen, generation, student_ids, ticket_ids, ticket_owners, gram_start);
+    }
+    free(student_ids);
+    free(ticket_ids);
+    free(ticket_owners);
+    free(gram_start);
+    return ok;
+}
+
+/* ------------------------ MENUS ------------------------ */
+
+void main_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("          HOSTEL MANAGEMENT SYSTEM\n");
+        printf("===============================================\n");
+        printf("1. ADMIN LOGIN\n");
+        printf("2. STUDENT ISSUE PORTAL\n");
+        printf("0. EXIT\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1:
+                admin_login();
+                break;
+            case 2:
+                student_menu();
+                break;
+            case 0:
+                printf("\nEXITING SYSTEM AND SAVING DATA...\n");
+                break;
+            default:
+                printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+void admin_login() {
+    char password[50];
+    int attempts = 0;
+
+    while (attempts < 3) {
+        printf("\nENTER ADMIN PASSWORD: ");
+        if (scanf("%49s", password) != 1) {
+            return;
+        }
+        clear_input_buffer();
+        if (strcmp(password, ADMIN_PASSWORD) == 0) {
+            printf("\nLOGIN SUCCESSFUL. WELCOME ADMIN.\n");
+            admin_menu();
+            return;
+        } else {
+            printf("\nWRONG PASSWORD. TRY AGAIN.\n");
+            attempts++;
+        }
+    }
+    printf("\nMAXIMUM ATTEMPTS REACHED. RETURNING TO MAIN MENU.\n");
+}
+
+void admin_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("              ADMIN MAIN MENU\n");
+        printf("===============================================\n");
+        printf("1. ADD NEW STUDENT\n");
+        printf("2. UPDATE STUDENT DETAILS\n");
+        printf("3. DELETE (SOFT DELETE) STUDENT\n");
+        printf("4. VIEW ALL STUDENTS (INCLUDING INACTIVE)\n");
+        printf("5. VIEW ONLY ACTIVE STUDENTS\n");
+        printf("6. SEARCH STUDENT BY ID\n");
+        printf("7. SEARCH STUDENT BY NAME\n");
+        printf("8. SORT STUDENTS BY NAME\n");
+        printf("9. SORT STUDENTS BY ROOM NUMBER\n");
+        printf("10. VIEW STUDENTS BY CAMPUS\n");
+        printf("11. DASHBOARD SUMMARY\n");
+        printf("12. EXPORT STUDENT REPORT TO FILE\n");
+        printf("13. RAISE ISSUE (ADMIN SIDE)\n");
+        printf("14. VIEW ALL ISSUES\n");
+        printf("15. VIEW ONLY OPEN ISSUES\n");
+        printf("16. UPDATE ISSUE STATUS\n");
+        printf("17. ROOM INVENTORY AND ALLOCATION\n");
+        printf("18. ISSUE SLA METRICS AND HISTORY\n");
+        printf("19. SNAPSHOTS AND POINT-IN-TIME RESTORE\n");
+        printf("20. ARCHIVE OLD RECORDS\n");
+        printf("21. GATE ENTRY / EXIT LOG\n");
+        printf("22. IMPORT / EXPORT STUDENTS (CSV / JSONL)\n");
+        printf("0. LOGOUT AND RETURN TO MAIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1:  add_student(); break;
+            case 2:  update_student(); break;
+            case 3:  delete_student(); break;
+            case 4:  view_all_students(); break;
+            case 5:  view_active_students(); break;
+            case 6:  search_student_by_id(); break;
+            case 7:  search_student_by_name(); break;
+            case 8:  sort_students_by_name(); break;
+            case 9:  sort_students_by_room(); break;
+            case 10: view_students_by_campus(); break;
+            case 11: dashboard(); break;
+            case 12: export_students_report(); break;
+            case 13: raise_issue_admin(); break;
+            case 14: view_all_tickets(); break;
+            case 15: view_open_tickets(); break;
+            case 16: update_ticket_status(); break;
+            case 17: room_inventory_menu(); break;
+            case 18: sla_menu(); break;
+            case 19: snapshot_menu(); break;
+            case 20: archive_menu(); break;
+            case 21: gate_menu(); break;
+            case 22: student_transfer_menu(); break;
+            case 0: 
+                printf("\nLOGGING OUT OF ADMIN PANEL...\n");
+                break;
+            default:
+                printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+
+        snapshot_tick();  // PERIODIC SNAPSHOT, COSTS ONLY THE PAGES CHANGED SINCE THE LAST ONE
+
+        request_save();  // SAVE AFTER EVERY CHANGE, WRITTEN BY THE BACKGROUND THREAD
+    } while (choice != 0);
+}
+
+void student_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("           STUDENT ISSUE PORTAL\n");
+        printf("===============================================\n");
+        printf("1. RAISE NEW ISSUE\n");
+        printf("2. CHECK ISSUE STATUS\n");
+        printf("0. BACK TO MAIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: raise_issue_student_portal(); break;
+            case 2: check_issue_status_student_portal(); break;
+            case 0: printf("\nRETURNING TO MAIN MENU...\n"); break;
+            default: printf("\nINVALID CHOICE. TRY AGAIN.\n");
+        }
+        request_save();
+    } while (choice != 0);
+}
+
+/* ---------------------- STUDENT FUNCTIONS ---------------------- */
+
+int find_student_by_id(int id) {
+    int e;
+    ensure_record_indexes();
+    e = index_lower_bound(student_id_index, student_count, id);
+    return e < student_count && student_id_index[e].key == id ? student_id_index[e].pos : -1;
+}
+
+void add_student() {
+    if (student_count >= MAX_STUDENTS) {
+        printf("\nSTUDENT LIMIT REACHED. CANNOT ADD MORE.\n");
+        return;
+    }
+
+    Student s;
+    int id;
+
+    memset(&s, 0, sizeof(Student));
+    printf("\nADDING NEW STUDENT\n");
+    printf("------------------\n");
+
+    id = read_int("ENTER UNIQUE STUDENT ID / ROLL NO: ");
+    if (find_student_by_id(id) != -1 || archive_fetch(ARCHIVE_STUDENTS, id, &s)) {
+        printf("\nSTUDENT WITH THIS ID ALREADY EXISTS. DUPLICATES NOT ALLOWED.\n");
+        return;
+    }
+    s.id = id;
+
+    for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+        read_student_field("ENTER", &student_fields[f], student_text(&s, &student_fields[f]));
+    }
+
+    s.is_active = 1;
+
+    /* ROOM IS CHECKED AFTER ALL PROMPTS SINCE THE BLOCK IS ASKED LAST */
+    if (!insert_student(&s)) {
+        printf("\nREQUESTED ROOM IS FULL OR NOT IN INVENTORY. STUDENT ADDED WITHOUT A ROOM.\n");
+    }
+    printf("\nSTUDENT ADDED SUCCESSFULLY.\n");
+}
+
+/* APPENDS A STUDENT WHOSE ID IS KNOWN TO BE FREE. RETURNS 0 IF THE REQUESTED ROOM
+   COULD NOT BE GIVEN, IN WHICH CASE THE STUDENT IS STORED WITHOUT A ROOM */
+int insert_student(Student *s) {
+    int has_room = !s->is_active || claim_student_room(s);
+    if (!has_room) {
+        s->room_no[0] = '\0';
+    }
+    students[student_count++] = *s;
+    mark_student_dirty(student_count - 1);
+    index_add_student(student_count - 1);
+    return has_room;
+}
+
+/* THE TEXT OF ONE FIELD INSIDE A STUDENT RECORD */
+char *student_text(const Student *s, const StudentField *f) {
+    return (char *)s + f->offset;
+}
+
+/* PROMPTS "<VERB> <LABEL><HINT>: " AND READS AT MOST THE FIELD SIZE */
+void read_student_field(const char *verb, const StudentField *f, char *buffer) {
+    char prompt[96];
+    snprintf(prompt, sizeof(prompt), "%s %s%s: ", verb, f->label, f->hint);
+    read_string(prompt, buffer, (int)f->size);
+}
+
+/* SETS ONE FIELD OF students[index], CUT TO THE FIELD SIZE. ROOM AND BLOCK CHANGES GO
+   THROUGH THE INVENTORY AND A NAME CHANGE MARKS THE NAME INDEX STALE. RETURNS 0 IF THE
+   NEW ROOM COULD NOT BE GIVEN, IN WHICH CASE THE STUDENT KEEPS THE OLD ONE */
+int set_student_field(int index, const StudentField *f, const char *value) {
+    Student *s = &students[index];
+    char *text = student_text(s, f);
+    char fitted[IMPORT_CELL_SIZE];
+
+    snprintf(fitted, f->size, "%s", value);
+    if (strcmp(text, fitted) == 0) return 1;
+    mark_student_dirty(index);
+
+    if (text == s->room_no || text == s->hostel_block) {
+        char new_block[sizeof(s->hostel_block)], new_room[sizeof(s->room_no)];
+        strcpy(new_block, text == s->hostel_block ? fitted : s->hostel_block);
+        strcpy(new_room, text == s->room_no ? fitted : s->room_no);
+        return move_student_room(index, new_block, new_room);
+    }
+    memset(text, 0, f->size);
+    strcpy(text, fitted);
+    if (text == s->name) {
+        name_index_stale = 1;
+    }
+    return 1;
+}
+
+/* GROUP MENU, THEN THE FIELDS OF THE CHOSEN GROUP, BOTH LISTED FROM student_fields[] */
+void update_student() {
+    const StudentField *members[STUDENT_FIELD_COUNT];
+    char value[IMPORT_CELL_SIZE];
+    int id, index, group, sub = 1, count = 0;
+
+    printf("\nUPDATE STUDENT DETAILS\n");
+    printf("----------------------\n");
+
+    id = read_int("ENTER STUDENT ID TO UPDATE: ");
+    index = find_student_by_id(id);
+
+    if (index == -1) {
+        printf("\nSTUDENT NOT FOUND.\n");
+        return;
+    }
+
+    printf("\nSELECT WHICH DETAIL TO UPDATE:\n");
+    for (int g = 1; g <= FIELD_GROUPS; g++) {
+        const char *separator = " (";
+        printf("%d. %s", g, student_group_names[g]);
+        for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+            if (student_fields[f].group != g) continue;
+            printf("%s%s", separator, student_fields[f].label);
+            separator = ", ";
+        }
+        printf(")\n");
+    }
+    printf("0. CANCEL\n");
+
+    group = read_int("ENTER YOUR OPTION: ");
+    if (group == 0) {
+        printf("\nUPDATE CANCELLED.\n");
+        return;
+    }
+    if (group < 1 || group > FIELD_GROUPS) {
+        printf("\nINVALID MAIN OPTION.\n");
+        return;
+    }
+
+    for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+        if (student_fields[f].group == group) members[count++] = &student_fields[f];
+    }
+    if (count > 1) {
+        printf("\n");
+        for (int k = 0; k < count; k++) {
+            printf("%d. UPDATE %s\n", k + 1, members[k]->label);
+        }
+        printf("0. BACK\n");
+        sub = read_int("ENTER CHOICE: ");
+        if (sub == 0) {
+            printf("\nNO CHANGE MADE.\n");
+            return;
+        }
+        if (sub < 1 || sub > count) {
+            printf("\nINVALID OPTION.\n");
+            return;
+        }
+    }
+
+    read_student_field("ENTER NEW", members[sub - 1], value);
+    if (!set_student_field(index, members[sub - 1], value)) {
+        int is_room = members[sub - 1]->offset == offsetof(Student, room_no);
+        printf("\nROOM %s IN BLOCK %s IS FULL OR NOT IN INVENTORY. ROOM NOT CHANGED.\n",
+               is_room ? value : students[index].room_no, is_room ? students[index].hostel_block : value);
+        return;
+    }
+
+    printf("\nSTUDENT DETAILS UPDATED SUCCESSFULLY.\n");
+}
+
+void delete_student() {
+    int id, index;
+    printf("\nDELETE (SOFT) STUDENT\n");
+    printf("---------------------\n");
+    id = read_int("ENTER STUDENT ID TO DELETE: ");
+    index = find_student_by_id(id);
+
+    if (index == -1) {
+        printf("\nSTUDENT NOT FOUND.\n");
+        return;
+    }
+
+    soft_delete_student(index);
+    printf("\nSTUDENT MARKED AS INACTIVE (SOFT DELETED).\n");
+}
+
+void soft_delete_student(int index) {
+    if (students[index].is_active) {
+        room_release_student(students[index].hostel_block, students[index].room_no, students[index].id);
+    }
+    students[index].is_active = 0;
+    mark_student_dirty(index);
+}
+
+void print_line() {
+    printf("---------------------------------------------------------------------------------------------\n");
+}
+
+void print_student_table_header() {
+    print_line();
+    printf("| ID  | NAME                 | ROOM | CAMPUS | YEAR | DEPT           | ACTIVE |\n");
+    print_line();
+}
+
+void print_student_row(Student s) {
+    printf("| %-3d | %-20s | %-4s | %-6s | %-4s | %-14s | %-6s |\n",
+           s.id,
+           s.name,
+           s.room_no,
+           s.campus,
+           s.year,
+           s.department,
+           s.is_active ? "YES" : "NO");
+}
+
+void view_all_students() {
+    if (student_count == 0) {
+        printf("\nNO STUDENTS IN DATABASE.\n");
+        return;
+    }
+    printf("\nALL STUDENTS (ACTIVE + INACTIVE)\n");
+    print_student_table_header();
+    for (int i = 0; i < student_count; i++) {
+        print_student_row(students[i]);
+    }
+    print_line();
+}
+
+void view_active_students() {
+    int found = 0;
+    printf("\nACTIVE STUDENTS ONLY\n");
+    print_student_table_header();
+    for (int i = 0; i < student_count; i++) {
+        if (students[i].is_active) {
+            print_student_row(students[i]);
+            found = 1;
+        }
+    }
+    print_line();
+    if (!found) {
+        printf("\nNO ACTIVE STUDENTS FOUND.\n");
+    }
+}
+
+void search_student_by_id() {
+    int id, index;
+    printf("\nSEARCH STUDENT BY ID\n");
+    id = read_int("ENTER STUDENT ID: ");
+    index = find_student_by_id(id);
+    if (index == -1) {
+        Student archived;
+        if (archive_fetch(ARCHIVE_STUDENTS, id, &archived)) {
+            printf("\nSTUDENT FOUND IN ARCHIVE.\n");
+            print_student_table_header();
+            print_student_row(archived);
+            print_line();
+            return;
+        }
+        printf("\nSTUDENT NOT FOUND.\n");
+        return;
+    }
+    print_student_table_header();
+    print_student_row(students[index]);
+    print_line();
+
+    /* ISSUES RAISED BY THIS STUDENT, ONE RANGE OF THE ISSUE OWNER INDEX */
+    for (int e = index_lower_bound(ticket_owner_index, ticket_count, id);
+         e < ticket_count && ticket_owner_index[e].key == id; e++) {
+        Ticket *t = &tickets[ticket_owner_index[e].pos];
+        if (e == 0 || ticket_owner_index[e - 1].key != id) printf("\nISSUES RAISED BY THIS STUDENT:\n");
+        printf("TICKET %-6d %-12s %s\n", t->ticket_id, t->status, t->issue);
+    }
+}
+
+/* ANY PART OF THE NAME MATCHES ("RAVI", "KUMAR", "VI KU"). CANDIDATES COME FROM THE NAME
+   PIECE INDEX; MATCHES ARE LISTED IN NAME ORDER */
+void search_student_by_name() {
+    char name[50];
+    int count;
+    int *matches;
+    printf("\nSEARCH STUDENT BY NAME\n");
+    read_string("ENTER NAME (FULL OR PART): ", name, sizeof(name));
+
+    if (student_count - name_gram_students > NAME_GRAM_TAIL) name_index_stale = 1;
+    ensure_record_indexes();
+    matches = malloc(student_count * sizeof(int) + 1);
+    if (matches == NULL) {
+        printf("\nNOT ENOUGH MEMORY TO SEARCH.\n");
+        return;
+    }
+    count = find_name_matches(name, matches);
+    qsort(matches, count, sizeof(int), compare_student_names);
+
+    print_student_table_header();
+    for (int k = 0; k < count; k++) {
+        print_student_row(students[matches[k]]);
+    }
+    print_line();
+    if (count == 0) {
+        printf("\nNO STUDENT MATCHING THIS NAME.\n");
+    }
+    free(matches);
+}
+
+void sort_students_by_name() {
+    if (student_count <= 1) {
+        printf("\nNOT ENOUGH STUDENTS TO SORT.\n");
+        return;
+    }
+    sort_students(0);
+    printf("\nSTUDENTS SORTED BY NAME.\n");
+    view_all_students();
+}
+
+void sort_students_by_room() {
+    if (student_count <= 1) {
+        printf("\nNOT ENOUGH STUDENTS TO SORT.\n");
+        return;
+    }
+    sort_students(1);
+    printf("\nSTUDENTS SORTED BY ROOM NUMBER.\n");
+    view_all_students();
+}
+
+void sort_students(int by_room) {
+    for (int i = 0; i < student_count - 1; i++) {
+        for (int j = 0; j < student_count - i - 1; j++) {
+            int cmp = by_room ? strcmp(students[j].room_no, students[j + 1].room_no)
+                              : strcmp(students[j].name, students[j + 1].name);
+            if (cmp > 0) {
+                Student temp = students[j];
+                students[j] = students[j + 1];
+                students[j + 1] = temp;
+                mark_student_dirty(j);
+                mark_student_dirty(j + 1);
+            }
+        }
+    }
+    student_index_stale = 1;    // POSITIONS MOVED, TICKETS DID NOT
+    name_index_stale = 1;
+}
+
+void view_students_by_campus() {
+    char campus[5];
+    int found = 0;
+    read_string("ENTER CAMPUS: ", campus, sizeof(campus));
+
+    printf("\nSTUDENTS IN CAMPUS: %s\n", campus);
+    print_student_table_header();
+    for (int i = 0; i < student_count; i++) {
+        if (strcmp(students[i].campus, campus) == 0) {
+            print_student_row(students[i]);
+            found = 1;
+        }
+    }
+    print_line();
+    if (!found) {
+        printf("\nNO STUDENTS FOUND FOR THIS CAMPUS.\n");
+    }
+}
+
+/* FANS OUT OVER THE SHARDS AND ADDS UP THEIR PARTS */
+void dashboard() {
+    ShardSummary parts[MAX_SHARDS];
+    ShardSummary total;
+
+    rebuild_shard_index();
+    memset(&total, 0, sizeof(total));
+    for (int s = 0; s < shard_count; s++) {
+        summarize_shard(s, &parts[s]);
+        total.students += parts[s].students;
+        total.active += parts[s].active;
+        total.campus_a += parts[s].campus_a;
+        total.campus_b += parts[s].campus_b;
+        total.tickets += parts[s].tickets;
+        total.open_issues += parts[s].open_issues;
+    }
+
+    printf("\n=================== DASHBOARD SUMMARY ===================\n");
+    printf("TOTAL STUDENTS          : %d\n", total.students);
+    printf("ACTIVE STUDENTS         : %d\n", total.active);
+    printf("CAMPUS A STUDENTS       : %d\n", total.campus_a);
+    printf("CAMPUS B STUDENTS       : %d\n", total.campus_b);
+    printf("TOTAL ISSUES RAISED     : %d\n", total.tickets);
+    printf("OPEN ISSUES             : %d\n", total.open_issues);
+    printf("STUDENTS OUTSIDE NOW    : %d\n", gate_outside_count);
+    printf("---------------------------------------------------------\n");
+    printf("%-10s %-10s %-10s %-10s %-10s\n", "SHARD", "STUDENTS", "ACTIVE", "ISSUES", "OPEN");
+    for (int s = 0; s < shard_count; s++) {
+        printf("%-10s %-10d %-10d %-10d %-10d\n", shards[s].key, parts[s].students,
+               parts[s].active, parts[s].tickets, parts[s].open_issues);
+    }
+    printf("=========================================================\n");
+}
+
+void export_students_report() {
+    FILE *fp = fopen(REPORT_FILE, "w");
+    if (fp == NULL) {
+        printf("\nUNABLE TO CREATE REPORT FILE.\n");
+        return;
+    }
+
+    fprintf(fp, "   HOSTEL MANAGEMENT SYSTEM - STUDENT REPORT\n");
+    fprintf(fp, "=============================================\n");
+    for (int i = 0; i < student_count; i++) {
+        fprintf(fp, "ID: %d\n", students[i].id);
+        for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+            fprintf(fp, "%s: %s\n", student_fields[f].label, student_text(&students[i], &student_fields[f]));
+        }
+        fprintf(fp, "ACTIVE: %s\n", students[i].is_active ? "YES" : "NO");
+        fprintf(fp, "---------------------------------------------\n");
+    }
+    fclose(fp);
+    printf("\nSTUDENT REPORT EXPORTED TO FILE: %s\n", REPORT_FILE);
+}
+
+/* ---------------------- STUDENT IMPORT / EXPORT (CSV / JSONL) ---------------------- */
+
+void student_transfer_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("        IMPORT / EXPORT STUDENTS\n");
+        printf("===============================================\n");
+        printf("1. EXPORT STUDENTS TO CSV (%s)\n", STUDENT_CSV_FILE);
+        printf("2. EXPORT STUDENTS TO JSON LINES (%s)\n", STUDENT_JSONL_FILE);
+        printf("3. IMPORT STUDENTS FROM CSV (%s)\n", STUDENT_CSV_FILE);
+        printf("4. IMPORT STUDENTS FROM JSON LINES (%s)\n", STUDENT_JSONL_FILE);
+        printf("5. LIST FIELD NAMES\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: export_students_file(0); break;
+            case 2: export_students_file(1); break;
+            case 3: import_students_file(0); break;
+            case 4: import_students_file(1); break;
+            case 5: list_student_columns(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+void list_student_columns() {
+    printf("\n%-16s %-22s %s\n", "FIELD", "LABEL", "MAX LENGTH");
+    print_line();
+    printf("%-16s %-22s %s\n", "id", "STUDENT ID / ROLL NO", "NUMBER");
+    for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+        printf("%-16s %-22s %d\n", student_fields[f].key, student_fields[f].label, (int)student_fields[f].size - 1);
+    }
+    printf("%-16s %-22s %s\n", "is_active", "ACTIVE", "1 / 0");
+    print_line();
+}
+
+/* COLUMN NUMBER FOR A FIELD NAME (ANY CASE, SURROUNDING SPACES IGNORED): A FIELD OF
+   student_fields[], COLUMN_ID, COLUMN_ACTIVE, OR -1 IF UNKNOWN */
+int find_student_column(const char *name) {
+    char key[IMPORT_CELL_SIZE];
+    int len = 0;
+
+    if (strncmp(name, "\xEF\xBB\xBF", 3) == 0) name += 3;     /* UTF-8 MARK SOME SPREADSHEETS ADD */
+    while (*name == ' ' || *name == '\t') name++;
+    for (; name[len] != '\0' && len < (int)sizeof(key) - 1; len++) {
+        char c = name[len];
+        key[len] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    }
+    while (len > 0 && (key[len - 1] == ' ' || key[len - 1] == '\t' || key[len - 1] == '\r')) len--;
+    key[len] = '\0';
+
+    if (strcmp(key, "id") == 0) return COLUMN_ID;
+    if (strcmp(key, "is_active") == 0) return COLUMN_ACTIVE;
+    for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+        if (strcmp(key, student_fields[f].key) == 0) return f;
+    }
+    return -1;
+}
+
+/* COMMA SEPARATED FIELD NAMES TO COLUMN NUMBERS, id FIRST AND EVERY COLUMN ONCE.
+   AN EMPTY LIST MEANS ALL. RETURNS THE COUNT, OR -1 AFTER NAMING AN UNKNOWN FIELD */
+int parse_column_list(const char *list, int *columns) {
+    int count = 1, taken[STUDENT_COLUMNS];
+
+    memset(taken, 0, sizeof(taken));
+    columns[0] = COLUMN_ID;
+    taken[COLUMN_ID] = 1;
+    if (list[strspn(list, " \t")] == '\0') {
+        for (int c = 0; c < STUDENT_COLUMNS; c++) {
+            if (!taken[c]) columns[count++] = c;
+        }
+        return count;
+    }
+    while (*list != '\0') {
+        char name[IMPORT_CELL_SIZE];
+        size_t len = strcspn(list, ",");
+        int c;
+
+        snprintf(name, sizeof(name), "%.*s", (int)(len < sizeof(name) ? len : sizeof(name) - 1), list);
+        list += len + (list[len] == ',');
+        if (name[strspn(name, " \t")] == '\0') continue;
+        c = find_student_column(name);
+        if (c == -1) {
+            printf("\nUNKNOWN FIELD: %s (OPTION 5 LISTS THE FIELD NAMES)\n", name);
+            return -1;
+        }
+        if (!taken[c]) {
+            taken[c] = 1;
+            columns[count++] = c;
+        }
+    }
+    return count;
+}
+
+void export_students_file(int jsonl) {
+    const char *path = jsonl ? STUDENT_JSONL_FILE : STUDENT_CSV_FILE;
+    int columns[STUDENT_COLUMNS], column_count, written;
+    char list[512];
+    FILE *fp;
+
+    read_string("FIELDS TO EXPORT, COMMA SEPARATED (EMPTY = ALL): ", list, sizeof(list));
+    column_count = parse_column_list(list, columns);
+    if (column_count < 0) return;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("\nUNABLE TO CREATE %s.\n", path);
+        return;
+    }
+    written = write_student_export(fp, jsonl, columns, column_count);
+    if (fclose(fp) != 0) written = -1;
+    if (written < 0) {
+        printf("\nWRITING %s FAILED. THE FILE IS INCOMPLETE.\n", path);
+        return;
+    }
+    printf("\n%d STUDENTS EXPORTED TO %s (%d FIELDS EACH).\n", written, path, column_count);
+}
+
+/* ONE LINE PER STUDENT (CSV AFTER A HEADER LINE), EACH BUILT IN MEMORY AND WRITTEN WITH
+   ONE CALL. RETURNS THE NUMBER OF STUDENTS WRITTEN, OR -1 ON A WRITE ERROR */
+int write_student_export(FILE *fp, int jsonl, const int *columns, int column_count) {
+    static char line[EXPORT_LINE_SIZE];
+    int pos = 0;
+
+    if (!jsonl) {
+        for (int k = 0; k < column_count; k++) {
+            int c = columns[k];
+            pos += sprintf(line + pos, "%s%s", k > 0 ? "," : "",
+                           c == COLUMN_ID ? "id" : c == COLUMN_ACTIVE ? "is_active" : student_fields[c].key);
+        }
+        line[pos++] = '\n';
+        line[pos] = '\0';
+        if (fputs(line, fp) == EOF) return -1;
+    }
+
+    for (int i = 0; i < student_count; i++) {
+        const Student *s = &students[i];
+        pos = 0;
+        if (jsonl) line[pos++] = '{';
+        for (int k = 0; k < column_count; k++) {
+            int c = columns[k];
+            if (k > 0) line[pos++] = ',';
+            if (jsonl) {
+                pos += sprintf(line + pos, "\"%s\":", c == COLUMN_ID ? "id" : c == COLUMN_ACTIVE ? "is_active" : student_fields[c].key);
+            }
+            if (c == COLUMN_ID) {
+                pos += sprintf(line + pos, "%d", s->id);
+            } else if (c == COLUMN_ACTIVE) {
+                line[pos++] = s->is_active ? '1' : '0';
+            } else if (jsonl) {
+                pos = json_put(line, pos, student_text(s, &student_fields[c]));
+            } else {
+                pos = csv_put(line, pos, student_text(s, &student_fields[c]));
+            }
+        }
+        if (jsonl) line[pos++] = '}';
+        line[pos++] = '\n';
+        line[pos] = '\0';
+        if (fputs(line, fp) == EOF) return -1;
+    }
+    return student_count;
+}
+
+/* CSV CELL: QUOTED ONLY WHEN IT HOLDS A COMMA, QUOTE OR LINE BREAK; QUOTES ARE DOUBLED */
+int csv_put(char *out, int pos, const char *text) {
+    if (text[strcspn(text, ",\"\r\n")] == '\0') {
+        size_t len = strlen(text);
+        memcpy(out + pos, text, len);
+        return pos + (int)len;
+    }
+    out[pos++] = '"';
+    for (; *text != '\0'; text++) {
+        if (*text == '"') out[pos++] = '"';
+        out[pos++] = *text;
+    }
+    out[pos++] = '"';
+    return pos;
+}
+
+/* JSON STRING: QUOTE, BACKSLASH AND CONTROL CHARACTERS ESCAPED, OTHER BYTES AS THEY ARE */
+int json_put(char *out, int pos, const char *text) {
+    out[pos++] = '"';
+    for (; *text != '\0'; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            out[pos++] = '\\';
+            out[pos++] = (char)c;
+        } else if (c == '\n') {
+            out[pos++] = '\\';
+            out[pos++] = 'n';
+        } else if (c == '\r') {
+            out[pos++] = '\\';
+            out[pos++] = 'r';
+        } else if (c == '\t') {
+            out[pos++] = '\\';
+            out[pos++] = 't';
+        } else if (c < 0x20) {
+            pos += sprintf(out + pos, "\\u%04x", c);
+        } else {
+            out[pos++] = (char)c;
+        }
+    }
+    out[pos++] = '"';
+    return pos;
+}
+
+/* IMPORTS THE WHOLE FILE: A NEW ID ADDS A STUDENT, A KNOWN ID UPDATES ONLY THE FIELDS
+   PRESENT IN THE FILE. COLUMNS OR KEYS THAT ARE NOT STUDENT FIELDS ARE IGNORED */
+void import_students_file(int jsonl) {
+    const char *path = jsonl ? STUDENT_JSONL_FILE : STUDENT_CSV_FILE;
+    ImportTally tally;
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        printf("\n%s NOT FOUND. %s\n", path, jsonl ? "EACH LINE SHOULD BE ONE OBJECT, E.G. {\"id\":7,\"name\":\"ARUN\"}"
+                                                  : "THE FIRST LINE SHOULD NAME THE COLUMNS, E.G. id,name,room_no");
+        return;
+    }
+    memset(&tally, 0, sizeof(tally));
+    tally.report = 1;
+    import_students(fp, jsonl, &tally);
+    fclose(fp);
+
+    printf("\nIMPORT FINISHED: %d ADDED, %d UPDATED, %d UNCHANGED, %d REFUSED, %d %s NOT UNDERSTOOD.\n",
+           tally.added, tally.updated, tally.unchanged, tally.refused, tally.bad, jsonl ? "LINES" : "ROWS");
+    if (tally.added_without_room > 0) {
+        printf("%d NEW STUDENTS WERE ADDED WITHOUT A ROOM (ROOM FULL OR NOT IN INVENTORY).\n", tally.added_without_room);
+    }
+}
+
+void import_students(FILE *fp, int jsonl, ImportTally *tally) {
+    static char cells[IMPORT_MAX_CELLS][IMPORT_CELL_SIZE];
+    static char keys[IMPORT_MAX_CELLS][IMPORT_CELL_SIZE];
+    static char line[EXPORT_LINE_SIZE];
+    int header[IMPORT_MAX_CELLS], header_count = 0, row = 0, n;
+
+    if (!jsonl) {
+        header_count = read_csv_row(fp, cells, IMPORT_MAX_CELLS);
+        for (int c = 0; c < header_count; c++) {
+            header[c] = find_student_column(cells[c]);
+        }
+        for (n = 0; n < header_count && header[n] != COLUMN_ID; n++) {}
+        if (n == header_count) {
+            tally->bad++;
+            if (tally->report) printf("THE FIRST LINE HAS NO id COLUMN. NOTHING IMPORTED.\n");
+            return;
+        }
+    }
+
+    for (;;) {
+        const char *values[STUDENT_COLUMNS];
+        const char *why;
+
+        if (jsonl) {
+            size_t len;
+            if (fgets(line, sizeof(line), fp) == NULL) break;
+            row++;
+            len = strlen(line);
+            if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+                int c;
+                while ((c = fgetc(fp)) != '\n' && c != EOF) {}
+                n = -1;
+            } else if (line[strspn(line, " \t\r\n")] == '\0') {
+                continue;
+            } else {
+                n = parse_json_object(line, keys, cells, IMPORT_MAX_CELLS);
+            }
+        } else {
+            n = read_csv_row(fp, cells, IMPORT_MAX_CELLS);
+            if (n < 0) break;
+            row++;
+            if (n == 1 && cells[0][0] == '\0') continue;
+        }
+        if (n < 0) {
+            if (tally->bad++ < 5 && tally->report) printf("LINE %d IGNORED: NOT ONE FLAT JSON OBJECT\n", row);
+            continue;
+        }
+
+        for (int c = 0; c < STUDENT_COLUMNS; c++) values[c] = NULL;
+        for (int c = 0; c < n; c++) {
+            int column = jsonl ? find_student_column(keys[c]) : c < header_count ? header[c] : -1;
+            if (column >= 0) values[column] = cells[c];
+        }
+        why = import_student_row(values, tally);
+        if (why != NULL && tally->refused++ < 5 && tally->report) {
+            printf("%s %d REFUSED: %s\n", jsonl ? "LINE" : "ROW", row, why);
+        }
+    }
+}
+
+/* RETURNS NULL, OR WHY THE ROW WAS REFUSED. values[] IS INDEXED BY COLUMN, NULL = ABSENT */
+const char *import_student_row(const char **values, ImportTally *tally) {
+    Student s, before;
+    char *end;
+    long id;
+    int index, has_room;
+
+    if (values[COLUMN_ID] == NULL) return "NO ID";
+    errno = 0;
+    id = strtol(values[COLUMN_ID], &end, 10);
+    while (*end == ' ' || *end == '\t') end++;
+    if (end == values[COLUMN_ID] || *end != '\0' || errno != 0 || id < INT_MIN || id > INT_MAX) {
+        return "ID IS NOT A WHOLE NUMBER";
+    }
+
+    index = find_student_by_id((int)id);
+    if (index != -1) {
+        const char *why = NULL;
+        int room_column = -1, block_column = -1;
+
+        before = students[index];
+        for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+            if (student_fields[f].offset == offsetof(Student, room_no)) {
+                room_column = f;
+            } else if (student_fields[f].offset == offsetof(Student, hostel_block)) {
+                block_column = f;
+            } else if (values[f] != NULL) {
+                set_student_field(index, &student_fields[f], values[f]);
+            }
+        }
+        /* ROOM AND BLOCK TOGETHER, AS ONE MOVE */
+        if (values[room_column] != NULL || values[block_column] != NULL) {
+            char block[sizeof(before.hostel_block)], room[sizeof(before.room_no)];
+            snprintf(block, sizeof(block), "%s", values[block_column] != NULL ? values[block_column] : before.hostel_block);
+            snprintf(room, sizeof(room), "%s", values[room_column] != NULL ? values[room_column] : before.room_no);
+            if (strcmp(block, before.hostel_block) != 0 || strcmp(room, before.room_no) != 0) {
+                mark_student_dirty(index);
+                if (!move_student_room(index, block, room)) why = "ROOM FULL OR NOT IN INVENTORY (OTHER FIELDS UPDATED)";
+            }
+        }
+        /* is_active WORKS LIKE DELETE / ADD: THE BED IS GIVEN UP OR MUST BE CLAIMED AGAIN */
+        if (values[COLUMN_ACTIVE] != NULL) {
+            int active = parse_active(values[COLUMN_ACTIVE]);
+            if (!active && students[index].is_active) {
+                soft_delete_student(index);
+            } else if (active && !students[index].is_active) {
+                students[index].is_active = 1;
+                if (claim_student_room(&students[index])) {
+                    mark_student_dirty(index);
+                } else {
+                    students[index].is_active = 0;
+                    if (why == NULL) why = "ROOM FULL OR NOT IN INVENTORY, STUDENT LEFT INACTIVE (OTHER FIELDS UPDATED)";
+                }
+            }
+        }
+        if (why == NULL) {
+            if (memcmp(&before, &students[index], sizeof(Student)) != 0) {
+                tally->updated++;
+            } else {
+                tally->unchanged++;
+            }
+        }
+        return why;
+    }
+
+    if (student_count >= MAX_STUDENTS) return "STUDENT LIMIT REACHED";
+    if (archive_fetch(ARCHIVE_STUDENTS, (int)id, &s)) return "ID BELONGS TO AN ARCHIVED STUDENT";
+    memset(&s, 0, sizeof(Student));
+    s.id = (int)id;
+    for (int f = 0; f < STUDENT_FIELD_COUNT; f++) {
+        if (values[f] != NULL) snprintf(student_text(&s, &student_fields[f]), student_fields[f].size, "%s", values[f]);
+    }
+    s.is_active = values[COLUMN_ACTIVE] == NULL || parse_active(values[COLUMN_ACTIVE]);
+
+    has_room = insert_student(&s);
+    tally->added++;
+    if (!has_room) tally->added_without_room++;
+    return NULL;
+}
+
+/* is_active COLUMN: 0, NO, N OR FALSE (ANY CASE) MEANS DELETED, ANYTHING ELSE ACTIVE */
+int parse_active(const char *text) {
+    char word[8];
+    int len = 0;
+
+    while (*text == ' ' || *text == '\t') text++;
+    for (; text[len] != '\0' && text[len] != ' ' && len < (int)sizeof(word) - 1; len++) {
+        char c = text[len];
+        word[len] = c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : c;
+    }
+    word[len] = '\0';
+    return strcmp(word, "0") != 0 && strcmp(word, "NO") != 0 && strcmp(word, "N") != 0 && strcmp(word, "FALSE") != 0;
+}
+
+/* ONE CSV RECORD: CELLS SPLIT ON COMMAS, A QUOTED CELL MAY HOLD COMMAS, "" FOR A QUOTE
+   AND LINE BREAKS. LONG CELLS ARE CUT, CELLS BEYOND max_cells DROPPED. RETURNS THE
+   NUMBER OF CELLS, OR -1 AT END OF FILE */
+int read_csv_row(FILE *fp, char cells[][IMPORT_CELL_SIZE], int max_cells) {
+    int count = 0, len = 0, quoted = 0, c = fgetc(fp);
+
+    if (c == EOF) return -1;
+    for (;;) {
+        if (quoted) {
+            if (c == EOF) {
+                quoted = 0;
+                continue;
+            }
+            if (c == '"') {
+                c = fgetc(fp);
+                if (c != '"') {
+                    quoted = 0;
+                    continue;
+                }
+            }
+        } else if (c == '"' && len == 0) {
+            quoted = 1;
+            c = fgetc(fp);
+            continue;
+        } else if (c == ',' || c == '\n' || c == EOF) {
+            if (count < max_cells) {
+                cells[count][len < IMPORT_CELL_SIZE ? len : IMPORT_CELL_SIZE - 1] = '\0';
+                count++;
+            }
+            len = 0;
+            if (c != ',') break;
+            c = fgetc(fp);
+            continue;
+        } else if (c == '\r') {
+            c = fgetc(fp);
+            if (c != '\n') {
+                if (c != EOF) ungetc(c, fp);
+                c = '\n';
+            }
+            continue;
+        }
+        if (count < max_cells && len < IMPORT_CELL_SIZE - 1) {
+            cells[count][len] = (char)c;
+        }
+        len++;
+        c = fgetc(fp);
+    }
+    return count;
+}
+
+/* ONE JSON OBJECT ON ONE LINE WHOSE VALUES ARE STRINGS, NUMBERS, true / false OR null
+   (null IS TAKEN AS AN EMPTY STRING). RETURNS THE NUMBER OF PAIRS, OR -1 IF THE LINE IS
+   ANYTHING ELSE. PAIRS BEYOND max_pairs ARE DROPPED */
+int parse_json_object(const char *line, char keys[][IMPORT_CELL_SIZE], char values[][IMPORT_CELL_SIZE], int max_pairs) {
+    char skipped[IMPORT_CELL_SIZE];
+    int count = 0;
+    const char *p = line + strspn(line, " \t");
+
+    if (*p++ != '{') return -1;
+    p += strspn(p, " \t");
+    if (*p == '}') {
+        p++;
+        return p[strspn(p, " \t\r\n")] == '\0' ? 0 : -1;
+    }
+    for (;;) {
+        char *key = count < max_pairs ? keys[count] : skipped;
+        char *value = count < max_pairs ? values[count] : skipped;
+
+        if (*p != '"' || (p = json_string(p, key, IMPORT_CELL_SIZE)) == NULL) return -1;
+        p += strspn(p, " \t");
+        if (*p++ != ':') return -1;
+        p += strspn(p, " \t");
+        if (*p == '"') {
+            if ((p = json_string(p, value, IMPORT_CELL_SIZE)) == NULL) return -1;
+        } else {
+            size_t len = strspn(p, "+-.0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+            if (len == 0) return -1;
+            if (len == 4 && strncmp(p, "null", 4) == 0) {
+                value[0] = '\0';
+            } else {
+                snprintf(value, IMPORT_CELL_SIZE, "%.*s", (int)(len < IMPORT_CELL_SIZE ? len : IMPORT_CELL_SIZE - 1), p);
+            }
+            p += len;
+        }
+        if (count < max_pairs) count++;
+        p += strspn(p, " \t");
+        if (*p == ',') {
+            p++;
+            p += strspn(p, " \t");
+            continue;
+        }
+        if (*p++ != '}') return -1;
+        p += strspn(p, " \t\r\n");
+        return *p == '\0' ? count : -1;
+    }
+}
+
+/* DECODES THE JSON STRING STARTING AT THE QUOTE p INTO out (CUT TO size). \uXXXX BECOMES
+   UTF-8. RETURNS THE POSITION AFTER THE CLOSING QUOTE, OR NULL IF THE STRING IS BROKEN */
+const char *json_string(const char *p, char *out, int size) {
+    int len = 0;
+
+    for (p++; *p != '"'; p++) {
+        unsigned char bytes[3];
+        int n = 1;
+
+        if ((unsigned char)*p < 0x20) return NULL;      /* ALSO THE END OF THE LINE */
+        bytes[0] = (unsigned char)*p;
+        if (*p == '\\') {
+            p++;
+            switch (*p) {
+                case '"': case '\\': case '/': bytes[0] = (unsigned char)*p; break;
+                case 'b': bytes[0] = '\b'; break;
+                case 'f': bytes[0] = '\f'; break;
+                case 'n': bytes[0] = '\n'; break;
+                case 'r': bytes[0] = '\r'; break;
+                case 't': bytes[0] = '\t'; break;
+                case 'u': {
+                    unsigned int code = 0;
+                    for (int k = 1; k <= 4; k++) {
+                        char h = p[k];
+                        int digit = h >= '0' && h <= '9' ? h - '0' : h >= 'a' && h <= 'f' ? h - 'a' + 10 :
+                                    h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+                        if (digit < 0) return NULL;
+                        code = code * 16 + (unsigned int)digit;
+                    }
+                    p += 4;
+                    if (code >= 0xD800 && code <= 0xDFFF) code = '?';  /* SURROGATE HALVES ARE NOT KEPT */
+                    if (code < 0x80) {
+                        bytes[0] = (unsigned char)code;
+                    } else if (code < 0x800) {
+                        bytes[0] = (unsigned char)(0xC0 | code >> 6);
+                        bytes[1] = (unsigned char)(0x80 | (code & 0x3F));
+                        n = 2;
+                    } else {
+                        bytes[0] = (unsigned char)(0xE0 | code >> 12);
+                        bytes[1] = (unsigned char)(0x80 | (code >> 6 & 0x3F));
+                        bytes[2] = (unsigned char)(0x80 | (code & 0x3F));
+                        n = 3;
+                    }
+                    break;
+                }
+                default: return NULL;
+            }
+        }
+        for (int k = 0; k < n && len < size - 1; k++) {
+            out[len++] = (char)bytes[k];
+        }
+    }
+    out[len] = '\0';
+    return p + 1;
+}
+
+/* ---------------------- ROOM INVENTORY ---------------------- */
+
+/* BITMAP WITH ONE BIT PER BED THAT EXISTS IN A ROOM OF THIS CAPACITY */
+unsigned int room_full_mask(int capacity) {
+    if (capacity >= MAX_BEDS_PER_ROOM) return 0xFFFFFFFFu;
+    return (1u << capacity) - 1u;
+}
+
+int count_set_bits(unsigned int x) {
+    int bits = 0;
+    while (x != 0) {
+        x &= x - 1;
+        bits++;
+    }
+    return bits;
+}
+
+/* INDEX OF THE LOWEST SET BIT, x MUST NOT BE ZERO */
+int lowest_set_bit(unsigned int x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int bit = 0;
+    while ((x & 1u) == 0) {
+        x >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+int find_block(const char *name) {
+    for (int b = 0; b < block_count; b++) {
+        if (strcmp(blocks[b].name, name) == 0) {
+            return b;
+        }
+    }
+    return -1;
+}
+
+int add_block(const char *name) {
+    int b = find_block(name);
+    if (b != -1) return b;
+    if (block_count >= MAX_BLOCKS) return -1;
+
+    b = block_count++;
+    memset(&blocks[b], 0, sizeof(BlockInventory));
+    strcpy(blocks[b].name, name);
+    return b;
+}
+
+int find_room(const char *block, const char *room_no) {
+    for (int r = 0; r < room_count; r++) {
+        if (strcmp(rooms[r].room_no, room_no) == 0 &&
+            strcmp(rooms[r].hostel_block, block) == 0) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+/* RETURNS THE BED NUMBER TAKEN, OR -1 WHEN THE ROOM IS FULL */
+int room_reserve_bed(int r, int student_id) {
+    unsigned int full = room_full_mask(rooms[r].capacity);
+    unsigned int free_beds = ~room_bed_mask[r] & full;
+    int bed;
+
+    if (free_beds == 0) return -1;
+
+    bed = lowest_set_bit(free_beds);
+    room_bed_mask[r] |= 1u << bed;
+    room_bed_student[r][bed] = student_id;
+    blocks[room_block[r]].free_beds--;
+
+    if (room_bed_mask[r] == full) {
+        blocks[room_block[r]].vacancy[r / 32] &= ~(1u << (r % 32));
+    }
+    return bed;
+}
+
+void room_release_student(const char *block, const char *room_no, int student_id) {
+    int r = find_room(block, room_no);
+    if (r == -1) return;
+
+    for (int bed = 0; bed < rooms[r].capacity; bed++) {
+        if ((room_bed_mask[r] & (1u << bed)) && room_bed_student[r][bed] == student_id) {
+            room_bed_mask[r] &= ~(1u << bed);
+            blocks[room_block[r]].free_beds++;
+            blocks[room_block[r]].vacancy[r / 32] |= 1u << (r % 32);
+            return;
+        }
+    }
+}
+
+/* FIRST ROOM OF THE BLOCK WITH A FREE BED, OR -1 */
+int first_free_room_in_block(int b) {
+    for (int w = 0; w < ROOM_WORDS; w++) {
+        if (blocks[b].vacancy[w] != 0) {
+            return w * 32 + lowest_set_bit(blocks[b].vacancy[w]);
+        }
+    }
+    return -1;
+}
+
+/* TAKES A BED FOR A NEW OR MOVED STUDENT. AN EMPTY ROOM NUMBER MEANS UNASSIGNED.
+   WITHOUT ANY INVENTORY THE ROOM STAYS FREE TEXT AS IN OLDER DATA FILES. */
+int claim_student_room(Student *s) {
+    int r;
+    if (s->room_no[0] == '\0') return 1;
+
+    r = find_room(s->hostel_block, s->room_no);
+    if (r == -1) return room_count == 0;
+    return room_reserve_bed(r, s->id) != -1;
+}
+
+/* MOVES AN ACTIVE STUDENT TO ANOTHER ROOM, KEEPING THE OLD BED IF THE NEW ONE IS NOT AVAILABLE */
+int move_student_room(int index, const char *new_block, const char *new_room) {
+    Student *s = &students[index];
+    char old_block[10], old_room[10];
+
+    strcpy(old_block, s->hostel_block);
+    strcpy(old_room, s->room_no);
+
+    if (s->is_active) {
+        room_release_student(old_block, old_room, s->id);
+    }
+    strcpy(s->hostel_block, new_block);
+    strcpy(s->room_no, new_room);
+
+    if (!s->is_active || claim_student_room(s)) {
+        return 1;
+    }
+
+    strcpy(s->hostel_block, old_block);
+    strcpy(s->room_no, old_room);
+    claim_student_room(s);
+    return 0;
+}
+
+void rebuild_room_occupancy() {
+    block_count = 0;
+    room_overbooked = 0;
+
+    for (int r = 0; r < room_count; r++) {
+        int b = add_block(rooms[r].hostel_block);
+        if (b == -1) b = 0;     /* BLOCK TABLE FULL, SHOULD NOT HAPPEN WITH add_room() CHECKS */
+        room_block[r] = b;
+        room_bed_mask[r] = 0;
+        blocks[b].room_total++;
+        blocks[b].free_beds += rooms[r].capacity;
+        blocks[b].vacancy[r / 32] |= 1u << (r % 32);
+    }
+
+    for (int i = 0; i < student_count; i++) {
+        if (!students[i].is_active || students[i].room_no[0] == '\0') continue;
+        int r = find_room(students[i].hostel_block, students[i].room_no);
+        if (r != -1 && room_reserve_bed(r, students[i].id) == -1) {
+            room_overbooked++;
+        }
+    }
+}
+
+void room_inventory_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("         ROOM INVENTORY AND ALLOCATION\n");
+        printf("===============================================\n");
+        printf("1. ADD ROOM TO INVENTORY\n");
+        printf("2. VIEW ALL ROOMS WITH OCCUPANCY\n");
+        printf("3. VIEW ONLY ROOMS WITH VACANCY\n");
+        printf("4. FIND FIRST FREE BED IN A BLOCK\n");
+        printf("5. BULK ALLOCATE STUDENTS WITHOUT A ROOM\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: add_room(); break;
+            case 2: view_all_rooms(); break;
+            case 3: view_rooms_with_vacancy(); break;
+            case 4: find_free_bed_in_block(); break;
+            case 5: bulk_allocate_rooms(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+void add_room() {
+    Room room;
+    int occupants = 0;
+
+    if (room_count >= MAX_ROOMS) {
+        printf("\nROOM LIMIT REACHED. CANNOT ADD MORE.\n");
+        return;
+    }
+
+    printf("\nADD ROOM TO INVENTORY\n");
+    printf("---------------------\n");
+    read_string("ENTER HOSTEL BLOCK: ", room.hostel_block, sizeof(room.hostel_block));
+    read_string("ENTER ROOM NUMBER: ", room.room_no, sizeof(room.room_no));
+    room.capacity = read_int("ENTER NUMBER OF BEDS (1 - 32): ");
+
+    if (room.room_no[0] == '\0' || room.capacity < 1 || room.capacity > MAX_BEDS_PER_ROOM) {
+        printf("\nINVALID ROOM NUMBER OR CAPACITY.\n");
+        return;
+    }
+
+    switch (insert_room(&room, &occupants)) {
+        case ROOM_DUPLICATE:
+            printf("\nROOM ALREADY EXISTS IN INVENTORY.\n");
+            break;
+        case ROOM_BLOCK_LIMIT:
+            printf("\nBLOCK LIMIT REACHED. CANNOT ADD A NEW BLOCK.\n");
+            break;
+        case ROOM_TOO_SMALL:
+            printf("\nROOM ALREADY HAS %d STUDENTS. CAPACITY TOO SMALL.\n", occupants);
+            break;
+        default:
+            printf("\nROOM ADDED SUCCESSFULLY (%d OF %d BEDS OCCUPIED).\n", occupants, room.capacity);
+    }
+}
+
+/* ADDS A VALIDATED ROOM (NUMBER SET, CAPACITY 1 - 32) WHEN THERE IS SPACE FOR IT */
+int insert_room(Room *room, int *occupants) {
+    *occupants = 0;
+    if (find_room(room->hostel_block, room->room_no) != -1) {
+        return ROOM_DUPLICATE;
+    }
+    if (find_block(room->hostel_block) == -1 && block_count >= MAX_BLOCKS) {
+        return ROOM_BLOCK_LIMIT;
+    }
+
+    /* STUDENTS ALREADY TYPED INTO THIS ROOM BEFORE IT WAS IN THE INVENTORY */
+    for (int i = 0; i < student_count; i++) {
+        if (students[i].is_active &&
+            strcmp(students[i].room_no, room->room_no) == 0 &&
+            strcmp(students[i].hostel_block, room->hostel_block) == 0) {
+            (*occupants)++;
+        }
+    }
+    if (*occupants > room->capacity) {
+        return ROOM_TOO_SMALL;
+    }
+
+    rooms[room_count++] = *room;
+    rebuild_room_occupancy();
+    note_store_change();
+    return ROOM_ADDED;
+}
+
+void print_room_table_header() {
+    print_line();
+    printf("| BLOCK | ROOM   | BEDS | USED | BED MAP (X = TAKEN)              |\n");
+    print_line();
+}
+
+void print_room_row(int r) {
+    char map[MAX_BEDS_PER_ROOM + 1];
+    int used = 0;
+
+    for (int bed = 0; bed < rooms[r].capacity; bed++) {
+        int taken = (room_bed_mask[r] >> bed) & 1u;
+        map[bed] = taken ? 'X' : '-';
+        used += taken;
+    }
+    map[rooms[r].capacity] = '\0';
+
+    printf("| %-5s | %-6s | %-4d | %-4d | %-32s |\n",
+           rooms[r].hostel_block,
+           rooms[r].room_no,
+           rooms[r].capacity,
+           used,
+           map);
+}
+
+void view_all_rooms() {
+    if (room_count == 0) {
+        printf("\nNO ROOMS IN INVENTORY.\n");
+        return;
+    }
+    printf("\nALL ROOMS\n");
+    print_room_table_header();
+    for (int r = 0; r < room_count; r++) {
+        print_room_row(r);
+    }
+    print_line();
+    for (int b = 0; b < block_count; b++) {
+        printf("BLOCK %-5s : %d ROOMS, %d FREE BEDS\n", blocks[b].name, blocks[b].room_total, blocks[b].free_beds);
+    }
+    if (room_overbooked > 0) {
+        printf("WARNING: %d STUDENTS HAVE NO BED LEFT IN THEIR ROOM.\n", room_overbooked);
+    }
+}
+
+void view_rooms_with_vacancy() {
+    int found = 0;
+    printf("\nROOMS WITH VACANCY\n");
+    print_room_table_header();
+    for (int b = 0; b < block_count; b++) {
+        for (int w = 0; w < ROOM_WORDS; w++) {
+            unsigned int bits = blocks[b].vacancy[w];
+            while (bits != 0) {
+                int bit = lowest_set_bit(bits);
+                print_room_row(w * 32 + bit);
+                bits &= bits - 1;
+                found = 1;
+            }
+        }
+    }
+    print_line();
+    if (!found) {
+        printf("\nNO VACANT BEDS IN ANY ROOM.\n");
+    }
+}
+
+void find_free_bed_in_block() {
+    char block[10];
+    int b, r, bed;
+
+    read_string("ENTER HOSTEL BLOCK: ", block, sizeof(block));
+    b = find_block(block);
+    if (b == -1) {
+        printf("\nNO ROOMS IN INVENTORY FOR THIS BLOCK.\n");
+        return;
+    }
+
+    r = first_free_room_in_block(b);
+    if (r == -1) {
+        printf("\nBLOCK %s IS FULL.\n", block);
+        return;
+    }
+    bed = lowest_set_bit(~room_bed_mask[r] & room_full_mask(rooms[r].capacity));
+    printf("\nFIRST FREE BED: BLOCK %s, ROOM %s, BED %d (%d FREE BEDS IN BLOCK)\n",
+           block, rooms[r].room_no, bed + 1, blocks[b].free_beds);
+}
+
+/* SINGLE PASS OVER THE STUDENTS: EACH ACTIVE STUDENT WITHOUT A ROOM GETS THE FIRST
+   FREE BED OF THEIR PREFERRED hostel_block, OR OF ANY BLOCK IF THAT ONE IS FULL */
+void bulk_allocate_rooms() {
+    int placed, moved_block, waiting;
+
+    if (room_count == 0) {
+        printf("\nNO ROOMS IN INVENTORY. ADD ROOMS FIRST.\n");
+        return;
+    }
+
+    placed = allocate_unassigned_students(&moved_block, &waiting);
+    printf("\nBULK ALLOCATION COMPLETE.\n");
+    printf("STUDENTS PLACED             : %d\n", placed);
+    printf("PLACED OUTSIDE PREFERENCE   : %d\n", moved_block);
+    printf("STILL WAITING FOR A BED     : %d\n", waiting);
+}
+
+int allocate_unassigned_students(int *moved_block, int *waiting) {
+    int placed = 0;
+
+    *moved_block = 0;
+    *waiting = 0;
+    for (int i = 0; i < student_count; i++) {
+        Student *s = &students[i];
+        int b, r = -1;
+
+        if (!s->is_active || s->room_no[0] != '\0') continue;
+
+        b = find_block(s->hostel_block);
+        if (b != -1) {
+            r = first_free_room_in_block(b);
+        }
+        for (int other = 0; r == -1 && other < block_count; other++) {
+            if (blocks[other].free_beds > 0) {
+                r = first_free_room_in_block(other);
+            }
+        }
+        if (r == -1) {
+            (*waiting)++;
+            continue;
+        }
+
+        room_reserve_bed(r, s->id);
+        if (strcmp(s->hostel_block, rooms[r].hostel_block) != 0) {
+            strcpy(s->hostel_block, rooms[r].hostel_block);
+            (*moved_block)++;
+        }
+        strcpy(s->room_no, rooms[r].room_no);
+        mark_student_dirty(i);
+        placed++;
+    }
+    return placed;
+}
+
+/* ---------------------- TICKET / ISSUE FUNCTIONS ---------------------- */
+
+int find_ticket_by_id(int tid) {
+    int e;
+    ensure_record_indexes();
+    e = index_lower_bound(ticket_id_index, ticket_count, tid);
+    return e < ticket_count && ticket_id_index[e].key == tid ? ticket_id_index[e].pos : -1;
+}
+
+int ticket_status_code(const char *status) {
+    if (strcmp(status, "RESOLVED") == 0) return TICKET_RESOLVED;
+    if (strcmp(status, "IN_PROGRESS") == 0) return TICKET_IN_PROGRESS;
+    return TICKET_OPEN;
+}
+
+const char *ticket_status_name(int code) {
+    switch (code) {
+        case TICKET_OPEN: return "OPEN";
+        case TICKET_IN_PROGRESS: return "IN_PROGRESS";
+        case TICKET_RESOLVED: return "RESOLVED";
+    }
+    return "NEW";
+}
+
+void log_ticket_transition(int ticket_id, unsigned int at, int from, int to) {
+    TicketTransition tr;
+    FILE *fp = fopen(TICKET_LOG_FILE, "ab");
+    if (fp == NULL) return;
+
+    memset(&tr, 0, sizeof(tr));
+    tr.ticket_id = ticket_id;
+    tr.at = at;
+    tr.from_status = (signed char)from;
+    tr.to_status = (signed char)to;
+    fwrite(&tr, sizeof(TicketTransition), 1, fp);
+    fclose(fp);
+}
+
+/* FILLS IN THE GENERATED PARTS OF A NEW TICKET (ISSUE TEXT ALREADY READ) AND STORES IT */
+void open_ticket(Ticket *t, int student_index) {
+    char issue[200];
+
+    memcpy(issue, t->issue, sizeof(issue));
+    memset(t, 0, sizeof(Ticket));
+    memcpy(t->issue, issue, sizeof(issue));
+
+    t->ticket_id = next_ticket_id++;
+    t->student_id = students[student_index].id;
+    strcpy(t->student_name, students[student_index].name);
+    strcpy(t->hostel_block, students[student_index].hostel_block);
+    strcpy(t->status, "OPEN");
+    t->created_at = (unsigned int)time(NULL);
+
+    tickets[ticket_count++] = *t;
+    mark_ticket_dirty(ticket_count - 1);
+    index_add_ticket(ticket_count - 1);
+    sla_track_open(&tickets[ticket_count - 1], 1);
+    log_ticket_transition(t->ticket_id, t->created_at, TICKET_NONE, TICKET_OPEN);
+}
+
+/* STATUS CHANGE WITH TIMESTAMPS, SLA AGGREGATES AND THE TRANSITION LOG KEPT IN STEP */
+void set_ticket_status(int index, int new_status) {
+    Ticket *t = &tickets[index];
+    int old_status = ticket_status_code(t->status);
+    unsigned int now = (unsigned int)time(NULL);
+
+    if (old_status == new_status) return;
+
+    if (old_status == TICKET_RESOLVED) {
+        /* REOPENED: TAKE THE EARLIER RESOLUTION BACK OUT OF THE AGGREGATES */
+        sla_track_resolution(t, -1);
+        t->resolved_at = 0;
+        sla_track_open(t, 1);
+    }
+    if (new_status == TICKET_IN_PROGRESS && t->in_progress_at == 0) {
+        t->in_progress_at = now;
+    }
+    if (new_status == TICKET_RESOLVED) {
+        sla_track_open(t, -1);
+        t->resolved_at = now;
+        sla_track_resolution(t, 1);
+    }
+
+    strcpy(t->status, ticket_status_name(new_status));
+    mark_ticket_dirty(index);
+    log_ticket_transition(t->ticket_id, now, old_status, new_status);
+}
+
+void raise_issue_student_portal() {
+    if (ticket_count >= MAX_TICKETS) {
+        printf("\nTICKET LIMIT REACHED. CANNOT RAISE MORE ISSUES.\n");
+        return;
+    }
+
+    int id, index;
+    Ticket t;
+
+    printf("\nRAISE ISSUE - STUDENT PORTAL\n");
+    id = read_int("ENTER YOUR STUDENT ID: ");
+    index = find_student_by_id(id);
+
+    if (index == -1 || !students[index].is_active) {
+        printf("\nSTUDENT NOT REGISTERED OR INACTIVE. ISSUE CANNOT BE RAISED.\n");
+        return;
+    }
+
+    read_string("ENTER YOUR ISSUE (ROOM / HOSTEL PROBLEM): ", t.issue, sizeof(t.issue));
+    open_ticket(&t, index);
+
+    printf("\nISSUE RAISED SUCCESSFULLY.\n");
+    printf("YOUR TICKET ID IS: %d\n", t.ticket_id);
+}
+
+void check_issue_status_student_portal() {
+    int tid, index;
+    printf("\nCHECK ISSUE STATUS\n");
+    tid = read_int("ENTER YOUR TICKET ID: ");
+    index = find_ticket_by_id(tid);
+
+    if (index == -1) {
+        Ticket archived;
+        if (archive_fetch(ARCHIVE_TICKETS, tid, &archived)) {
+            print_ticket_details(&archived);
+            return;
+        }
+        printf("\nNO SUCH TICKET FOUND.\n");
+        return;
+    }
+
+    print_ticket_details(&tickets[index]);
+}
+
+void print_ticket_details(Ticket *t) {
+    printf("\nTICKET DETAILS:\n");
+    printf("TICKET ID  : %d\n", t->ticket_id);
+    printf("STUDENT ID : %d\n", t->student_id);
+    printf("STUDENT    : %s\n", t->student_name);
+    printf("ISSUE      : %s\n", t->issue);
+    printf("STATUS     : %s\n", t->status);
+
+    if (t->created_at != 0) {
+        char when[32];
+        format_time(t->created_at, when, sizeof(when));
+        printf("RAISED ON  : %s\n", when);
+        if (t->in_progress_at != 0) {
+            format_time(t->in_progress_at, when, sizeof(when));
+            printf("TAKEN UP ON: %s\n", when);
+        }
+        if (t->resolved_at != 0) {
+            format_time(t->resolved_at, when, sizeof(when));
+            printf("RESOLVED ON: %s\n", when);
+        }
+    }
+}
+
+void raise_issue_admin() {
+    if (ticket_count >= MAX_TICKETS) {
+        printf("\nTICKET LIMIT REACHED. CANNOT RAISE MORE ISSUES.\n");
+        return;
+    }
+
+    int id, index;
+    Ticket t;
+
+    printf("\nRAISE ISSUE - ADMIN SIDE\n");
+    id = read_int("ENTER STUDENT ID: ");
+    index = find_student_by_id(id);
+
+    if (index == -1 || !students[index].is_active) {
+        printf("\nSTUDENT NOT REGISTERED OR INACTIVE. ISSUE CANNOT BE RAISED.\n");
+        return;
+    }
+
+    read_string("ENTER ISSUE DETAILS: ", t.issue, sizeof(t.issue));
+    open_ticket(&t, index);
+
+    printf("\nISSUE RAISED SUCCESSFULLY FOR STUDENT.\n");
+    printf("TICKET ID: %d\n", t.ticket_id);
+}
+
+void view_all_tickets() {
+    if (ticket_count == 0) {
+        printf("\nNO ISSUES RAISED YET.\n");
+        return;
+    }
+    printf("\nALL ISSUES / TICKETS\n");
+    print_line();
+    printf("| TID | STU_ID | STUDENT NAME        | STATUS       |\n");
+    print_line();
+    for (int i = 0; i < ticket_count; i++) {
+        printf("| %-3d | %-6d | %-18s | %-11s |\n",
+               tickets[i].ticket_id,
+               tickets[i].student_id,
+               tickets[i].student_name,
+               tickets[i].status);
+    }
+    print_line();
+}
+
+void view_open_tickets() {
+    int found = 0;
+    printf("\nOPEN ISSUES ONLY\n");
+    print_line();
+    printf("| TID | STU_ID | STUDENT NAME        | STATUS |\n");
+    print_line();
+    for (int i = 0; i < ticket_count; i++) {
+        if (strcmp(tickets[i].status, "OPEN") == 0) {
+            printf("| %-3d | %-6d | %-18s | %-6s |\n",
+                   tickets[i].ticket_id,
+                   tickets[i].student_id,
+                   tickets[i].student_name,
+                   tickets[i].status);
+            found = 1;
+        }
+    }
+    print_line();
+    if (!found) {
+        printf("\nNO OPEN ISSUES.\n");
+    }
+}
+
+void update_ticket_status() {
+    int tid, index, choice;
+    printf("\nUPDATE ISSUE STATUS (ADMIN ONLY)\n");
+    tid = read_int("ENTER TICKET ID: ");
+    index = find_ticket_by_id(tid);
+
+    if (index == -1) {
+        printf("\nTICKET NOT FOUND.\n");
+        return;
+    }
+
+    printf("\nCURRENT STATUS: %s\n", tickets[index].status);
+    printf("1. SET STATUS TO OPEN\n");
+    printf("2. SET STATUS TO IN_PROGRESS\n");
+    printf("3. SET STATUS TO RESOLVED\n");
+    printf("0. CANCEL\n");
+
+    choice = read_int("ENTER CHOICE: ");
+    switch (choice) {
+        case 1: set_ticket_status(index, TICKET_OPEN); break;
+        case 2: set_ticket_status(index, TICKET_IN_PROGRESS); break;
+        case 3: set_ticket_status(index, TICKET_RESOLVED); break;
+        case 0: printf("\nNO CHANGE MADE.\n"); return;
+        default: printf("\nINVALID OPTION.\n"); return;
+    }
+    printf("\nTICKET STATUS UPDATED SUCCESSFULLY.\n");
+}
+
+/* ---------------------- ISSUE SLA METRICS ---------------------- */
+
+void format_time(unsigned int t, char *buf, int size) {
+    time_t raw = (time_t)t;
+    struct tm *tm_info = localtime(&raw);
+    if (tm_info == NULL || strftime(buf, size, "%d/%m/%Y %H:%M", tm_info) == 0) {
+        snprintf(buf, size, "%u", t);
+    }
+}
+
+/* THE FIRST MAX_BLOCKS NAMES SEEN GET A ROW EACH; ANY FURTHER BLOCK IS ADDED TO AN
+   EXTRA ROW THAT THE REPORTS SHOW AS SLA_OTHER_BLOCKS */
+SlaBlockStats *sla_block(const char *name) {
+    int named = sla_block_count < MAX_BLOCKS ? sla_block_count : MAX_BLOCKS;
+    for (int b = 0; b < named; b++) {
+        if (strcmp(sla_blocks[b].name, name) == 0) {
+            return &sla_blocks[b];
+        }
+    }
+    if (sla_block_count == MAX_BLOCKS) {
+        memset(&sla_blocks[MAX_BLOCKS], 0, sizeof(SlaBlockStats));
+        strcpy(sla_blocks[MAX_BLOCKS].name, SLA_OTHER_BLOCKS);
+        sla_block_count++;
+    }
+    if (sla_block_count > MAX_BLOCKS) {
+        return &sla_blocks[MAX_BLOCKS];
+    }
+    memset(&sla_blocks[sla_block_count], 0, sizeof(SlaBlockStats));
+    strcpy(sla_blocks[sla_block_count].name, name);
+    return &sla_blocks[sla_block_count++];
+}
+
+/* EXACT BELOW 8 SECONDS, THEN 8 SUB-BUCKETS PER POWER OF TWO (UNDER 12.5% ERROR) */
+int sla_bucket(unsigned int secs) {
+    int e = 31;
+    if (secs < 8) return (int)secs;
+    while ((secs >> e) == 0) e--;
+    return (e - 2) * 8 + (int)((secs >> (e - 3)) & 7u);
+}
+
+unsigned int sla_bucket_upper(int bucket) {
+    int e, sub;
+    if (bucket < 8) return (unsigned int)bucket;
+    e = bucket / 8 + 2;
+    sub = bucket % 8;
+    return (unsigned int)((((unsigned long long)(8 + sub + 1)) << (e - 3)) - 1);
+}
+
+unsigned int sla_percentile(SlaBlockStats *b, int percent) {
+    long long rank = ((long long)b->resolved * percent + 99) / 100;
+    long long seen = 0;
+    if (b->resolved <= 0) return 0;
+    if (rank < 1) rank = 1;
+    for (int i = 0; i < SLA_RES_BUCKETS; i++) {
+        seen += b->resolve_hist[i];
+        if (seen >= rank) return sla_bucket_upper(i);
+    }
+    return sla_bucket_upper(SLA_RES_BUCKETS - 1);
+}
+
+/* delta = +1 WHEN A TICKET BECOMES OPEN / REOPENED, -1 WHEN IT IS RESOLVED */
+void sla_track_open(Ticket *t, int delta) {
+    unsigned int day = t->created_at / SECONDS_PER_DAY;
+    int slot = (int)(day % SLA_DAY_SLOTS);
+
+    if (t->created_at == 0) {
+        sla_untracked += delta;
+        return;
+    }
+    sla_block(t->hostel_block)->open += delta;
+
+    if (sla_open_day_tag[slot] == day) {
+        sla_open_day_count[slot] += delta;
+    } else if (sla_open_day_tag[slot] < day) {
+        /* SLOT STILL HOLDS A DAY FROM SLA_DAY_SLOTS OR MORE DAYS AGO */
+        sla_open_older += sla_open_day_count[slot];
+        sla_open_day_tag[slot] = day;
+        sla_open_day_count[slot] = delta;
+    } else {
+        sla_open_older += delta;
+    }
+}
+
+void sla_track_resolution(Ticket *t, int delta) {
+    SlaBlockStats *b;
+    unsigned int secs;
+
+    if (t->created_at == 0 || t->resolved_at < t->created_at) return;
+
+    b = sla_block(t->hostel_block);
+    secs = t->resolved_at - t->created_at;
+    b->resolved += delta;
+    b->total_resolve_secs += (long long)delta * secs;
+    b->resolve_hist[sla_bucket(secs)] += delta;
+    if (secs > SLA_BREACH_HOURS * 3600u) {
+        b->resolved_late += delta;
+    }
+}
+
+/* ONE PASS OVER THE CURRENT TICKETS AT LOAD TIME, THE LOG IS NEVER REPLAYED */
+void rebuild_sla_stats() {
+    memset(sla_open_day_count, 0, sizeof(sla_open_day_count));
+    memset(sla_open_day_tag, 0, sizeof(sla_open_day_tag));
+    sla_open_older = 0;
+    sla_untracked = 0;
+    sla_block_count = 0;
+
+    for (int i = 0; i < ticket_count; i++) {
+        if (ticket_status_code(tickets[i].status) == TICKET_RESOLVED) {
+            sla_track_resolution(&tickets[i], 1);
+        } else {
+            sla_track_open(&tickets[i], 1);
+        }
+    }
+}
+
+/* OPEN TICKETS BY AGE: < 1 DAY, 1-3 DAYS, 3-7 DAYS, 7-30 DAYS, OVER 30 DAYS */
+void sla_open_age_histogram(unsigned int now, int out[5]) {
+    unsigned int today = now / SECONDS_PER_DAY;
+    memset(out, 0, 5 * sizeof(int));
+
+    for (int slot = 0; slot < SLA_DAY_SLOTS; slot++) {
+        unsigned int age;
+        if (sla_open_day_count[slot] == 0) continue;
+        age = today >= sla_open_day_tag[slot] ? today - sla_open_day_tag[slot] : 0;
+        if (age < 1) out[0] += sla_open_day_count[slot];
+        else if (age < 3) out[1] += sla_open_day_count[slot];
+        else if (age < 7) out[2] += sla_open_day_count[slot];
+        else if (age <= 30) out[3] += sla_open_day_count[slot];
+        else out[4] += sla_open_day_count[slot];
+    }
+    out[4] += sla_open_older;
+}
+
+/* OPEN TICKETS MORE THAN SLA_BREACH_HOURS OLD, CHECKED TO THE SECOND, OPTIONALLY PRINTED
+   AS TABLE ROWS. THE SCREEN LISTING AND THE EXPORTED COUNT BOTH COME FROM THIS ONE WALK SO
+   THEY ALWAYS AGREE; TICKETS ARE NOT ASSUMED TO BE IN CREATION ORDER */
+int scan_breaching_tickets(unsigned int now, int print) {
+    unsigned int limit = SLA_BREACH_HOURS * 3600u;
+    int breaching = 0;
+
+    for (int i = 0; i < ticket_count; i++) {
+        Ticket *t = &tickets[i];
+        if (t->created_at == 0 || now < t->created_at || now - t->created_at <= limit) continue;
+        if (ticket_status_code(t->status) == TICKET_RESOLVED) continue;
+
+        if (print) {
+            printf("| %-3d | %-6d | %-18s | %-5s | %-11s | %-6u |\n",
+                   t->ticket_id, t->student_id, t->student_name, t->hostel_block,
+                   t->status, (now - t->created_at) / 3600u);
+        }
+        breaching++;
+    }
+    return breaching;
+}
+
+void sla_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("          ISSUE SLA METRICS AND HISTORY\n");
+        printf("===============================================\n");
+        printf("1. VIEW SLA METRICS\n");
+        printf("2. VIEW STATUS HISTORY OF A TICKET\n");
+        printf("3. EXPORT SLA METRICS TO JSON\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: view_sla_metrics(); break;
+            case 2: view_ticket_history(); break;
+            case 3: export_sla_json(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+void view_sla_metrics() {
+    unsigned int now = (unsigned int)time(NULL);
+    int age[5];
+
+    sla_open_age_histogram(now, age);
+
+    printf("\n=================== ISSUE SLA METRICS ===================\n");
+    printf("OPEN ISSUES BY AGE\n");
+    printf("  UNDER 1 DAY           : %d\n", age[0]);
+    printf("  1 - 3 DAYS            : %d\n", age[1]);
+    printf("  3 - 7 DAYS            : %d\n", age[2]);
+    printf("  7 - 30 DAYS           : %d\n", age[3]);
+    printf("  OVER 30 DAYS          : %d\n", age[4]);
+    if (sla_untracked > 0) {
+        printf("  NO TIMESTAMP (OLD)    : %d\n", sla_untracked);
+    }
+
+    printf("\nOPEN ISSUES BREACHING %d HOURS\n", SLA_BREACH_HOURS);
+    print_line();
+    printf("| TID | STU_ID | STUDENT NAME       | BLOCK | STATUS      | HOURS  |\n");
+    print_line();
+    if (scan_breaching_tickets(now, 1) == 0) {
+        printf("| NONE                                                              |\n");
+    }
+    print_line();
+
+    printf("\nRESOLUTION TIME PER BLOCK\n");
+    print_line();
+    printf("| BLOCK | OPEN | RESOLVED | MEAN HRS | P95 HRS  | LATE |\n");
+    print_line();
+    for (int b = 0; b < sla_block_count; b++) {
+        SlaBlockStats *st = &sla_blocks[b];
+        double mean = st->resolved > 0 ? (double)st->total_resolve_secs / st->resolved / 3600.0 : 0.0;
+        printf("| %-5s | %-4d | %-8d | %-8.1f | %-8.1f | %-4d |\n",
+               st->name, st->open, st->resolved, mean,
+               sla_percentile(st, 95) / 3600.0, st->resolved_late);
+    }
+    print_line();
+    if (sla_block_count > MAX_BLOCKS) {
+        printf("%s ADDS UP EVERY BLOCK AFTER THE FIRST %d.\n", SLA_OTHER_BLOCKS, MAX_BLOCKS);
+    }
+}
+
+void view_ticket_history() {
+    TicketTransition tr;
+    int tid, found = 0;
+    FILE *fp;
+
+    tid = read_int("ENTER TICKET ID: ");
+    fp = fopen(TICKET_LOG_FILE, "rb");
+    if (fp == NULL) {
+        printf("\nNO STATUS HISTORY RECORDED YET.\n");
+        return;
+    }
+
+    printf("\nSTATUS HISTORY OF TICKET %d\n", tid);
+    print_line();
+    while (fread(&tr, sizeof(TicketTransition), 1, fp) == 1) {
+        char when[32];
+        if (tr.ticket_id != tid) continue;
+        format_time(tr.at, when, sizeof(when));
+        printf("%s  %-11s -> %s\n", when, ticket_status_name(tr.from_status), ticket_status_name(tr.to_status));
+        found = 1;
+    }
+    fclose(fp);
+    print_line();
+    if (!found) {
+        printf("\nNO HISTORY FOR THIS TICKET.\n");
+    }
+}
+
+void export_sla_json() {
+    unsigned int now = (unsigned int)time(NULL);
+    int age[5];
+    FILE *fp = fopen(SLA_JSON_FILE, "w");
+    if (fp == NULL) {
+        printf("\nUNABLE TO CREATE SLA REPORT FILE.\n");
+        return;
+    }
+
+    sla_open_age_histogram(now, age);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"generated_at\": %u,\n", now);
+    fprintf(fp, "  \"breach_threshold_hours\": %d,\n", SLA_BREACH_HOURS);
+    fprintf(fp, "  \"open_age_histogram\": {\"under_1d\": %d, \"1d_3d\": %d, \"3d_7d\": %d, \"7d_30d\": %d, \"over_30d\": %d},\n",
+            age[0], age[1], age[2], age[3], age[4]);
+    fprintf(fp, "  \"open_without_timestamp\": %d,\n", sla_untracked);
+    fprintf(fp, "  \"open_breaching\": %d,\n", scan_breaching_tickets(now, 0));
+    fprintf(fp, "  \"blocks\": [");
+    for (int b = 0; b < sla_block_count; b++) {
+        SlaBlockStats *st = &sla_blocks[b];
+        double mean = st->resolved > 0 ? (double)st->total_resolve_secs / st->resolved / 3600.0 : 0.0;
+        fprintf(fp, "%s\n    {\"block\": \"", b == 0 ? "" : ",");
+        for (const char *c = st->name; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') fputc('\\', fp);
+            if ((unsigned char)*c >= 0x20) fputc(*c, fp);
+        }
+        fprintf(fp, "\", \"open\": %d, \"resolved\": %d, \"mean_resolution_hours\": %.2f, "
+                    "\"p95_resolution_hours\": %.2f, \"resolved_late\": %d%s}",
+                st->open, st->resolved, mean, sla_percentile(st, 95) / 3600.0, st->resolved_late,
+                b == MAX_BLOCKS ? ", \"other_blocks\": true" : "");
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+    printf("\nSLA METRICS EXPORTED TO FILE: %s\n", SLA_JSON_FILE);
+}
+
+/* ---------------------- SNAPSHOTS (COPY-ON-WRITE) ---------------------- */
+
+void mark_student_dirty(int index) {
+    student_page_dirty[index / PAGE_RECORDS] = 1;
+    note_store_change();
+}
+
+void mark_ticket_dirty(int index) {
+    ticket_page_dirty[index / PAGE_RECORDS] = 1;
+    note_store_change();
+}
+
+void mark_all_dirty() {
+    memset(student_page_dirty, 1, sizeof(student_page_dirty));
+    memset(ticket_page_dirty, 1, sizeof(ticket_page_dirty));
+    note_store_change();
+}
+
+SnapshotPage *capture_page(const void *records, int count, size_t record_size) {
+    SnapshotPage *page = malloc(sizeof(SnapshotPage) + PAGE_RECORDS * record_size);
+    if (page == NULL) return NULL;
+    page->refs = 1;
+    page->records = count;
+    memcpy(page->data, records, count * record_size);
+    return page;
+}
+
+void release_page(SnapshotPage *page) {
+    if (page != NULL && --page->refs == 0) {
+        free(page);
+    }
+}
+
+void release_generation(Snapshot *snap) {
+    for (int p = 0; p < snap->student_page_count; p++) release_page(snap->student_pages[p]);
+    for (int p = 0; p < snap->ticket_page_count; p++) release_page(snap->ticket_pages[p]);
+    free(snap->student_pages);
+    free(snap->ticket_pages);
+    memset(snap, 0, sizeof(Snapshot));
+}
+
+/* SECOND OWNER OF THE SAME PAGES, NOTHING IS COPIED. RETURNS 0, WITH dst LEFT EMPTY,
+   IF THE PAGE LISTS CANNOT BE ALLOCATED */
+int copy_generation(Snapshot *dst, Snapshot *src) {
+    *dst = *src;
+    dst->student_pages = malloc(src->student_page_count * sizeof(SnapshotPage *) + 1);
+    dst->ticket_pages = malloc(src->ticket_page_count * sizeof(SnapshotPage *) + 1);
+    if (dst->student_pages == NULL || dst->ticket_pages == NULL) {
+        free(dst->student_pages);
+        free(dst->ticket_pages);
+        memset(dst, 0, sizeof(Snapshot));
+        return 0;
+    }
+    for (int p = 0; p < src->student_page_count; p++) {
+        dst->student_pages[p] = src->student_pages[p];
+        dst->student_pages[p]->refs++;
+    }
+    for (int p = 0; p < src->ticket_page_count; p++) {
+        dst->ticket_pages[p] = src->ticket_pages[p];
+        dst->ticket_pages[p]->refs++;
+    }
+    return 1;
+}
+
+/* BUILDS A GENERATION OF THE LIVE STORES. CLEAN PAGES ARE SHARED WITH cow_base, SO THE
+   COST IS THE NUMBER OF PAGES CHANGED SINCE THE PREVIOUS CAPTURE. RETURNS 0 IF MEMORY RUNS
+   OUT: snap IS LEFT EMPTY AND cow_base AND THE DIRTY BITMAPS ARE UNTOUCHED */
+int capture_generation(Snapshot *snap) {
+    Snapshot base;
+    int student_pages, ticket_pages;
+
+    memset(snap, 0, sizeof(Snapshot));
+    snap->taken_at = (unsigned int)time(NULL);
+    snap->student_count = student_count;
+    snap->ticket_count = ticket_count;
+    snap->next_ticket_id = next_ticket_id;
+    student_pages = (student_count + PAGE_RECORDS - 1) / PAGE_RECORDS;
+    ticket_pages = (ticket_count + PAGE_RECORDS - 1) / PAGE_RECORDS;
+    snap->student_pages = malloc(student_pages * sizeof(SnapshotPage *) + 1);
+    snap->ticket_pages = malloc(ticket_pages * sizeof(SnapshotPage *) + 1);
+    if (snap->student_pages == NULL || snap->ticket_pages == NULL) {
+        release_generation(snap);
+        return 0;
+    }
+
+    /* THE PAGE COUNTS GROW WITH EACH PAGE TAKEN, SO release_generation() FREES EXACTLY THOSE */
+    for (int p = 0; p < student_pages; p++) {
+        int first = p * PAGE_RECORDS;
+        int count = student_count - first < PAGE_RECORDS ? student_count - first : PAGE_RECORDS;
+        if (!student_page_dirty[p] && p < cow_base.student_page_count &&
+            cow_base.student_pages[p]->records == count) {
+            snap->student_pages[p] = cow_base.student_pages[p];
+            snap->student_pages[p]->refs++;
+        } else {
+            snap->student_pages[p] = capture_page(&students[first], count, sizeof(Student));
+            if (snap->student_pages[p] == NULL) {
+                release_generation(snap);
+                return 0;
+            }
+            snap->new_pages++;
+        }
+        snap->student_page_count++;
+    }
+    for (int p = 0; p < ticket_pages; p++) {
+        int first = p * PAGE_RECORDS;
+        int count = ticket_count - first < PAGE_RECORDS ? ticket_count - first : PAGE_RECORDS;
+        if (!ticket_page_dirty[p] && p < cow_base.ticket_page_count &&
+            cow_base.ticket_pages[p]->records == count) {
+            snap->ticket_pages[p] = cow_base.ticket_pages[p];
+            snap->ticket_pages[p]->refs++;
+        } else {
+            snap->ticket_pages[p] = capture_page(&tickets[first], count, sizeof(Ticket));
+            if (snap->ticket_pages[p] == NULL) {
+                release_generation(snap);
+                return 0;
+            }
+            snap->new_pages++;
+        }
+        snap->ticket_page_count++;
+    }
+
+    if (!copy_generation(&base, snap)) {
+        release_generation(snap);
+        return 0;
+    }
+    release_generation(&cow_base);
+    cow_base = base;
+    memset(student_page_dirty, 0, sizeof(student_page_dirty));
+    memset(ticket_page_dirty, 0, sizeof(ticket_page_dirty));
+    return 1;
+}
+
+int find_snapshot(int id) {
+    for (int i = 0; i < snapshot_count; i++) {
+        if (snapshots[i].id == id) return i;
+    }
+    return -1;
+}
+
+void take_snapshot(int automatic) {
+    Snapshot snap;
+
+    /* THE OLDEST SNAPSHOT IS ONLY DROPPED ONCE THE NEW ONE EXISTS */
+    if (!capture_generation(&snap)) {
+        printf("\nNOT ENOUGH MEMORY FOR A SNAPSHOT. NONE TAKEN.\n");
+        return;
+    }
+    if (snapshot_count == MAX_SNAPSHOTS) {
+        release_generation(&snapshots[0]);
+        memmove(&snapshots[0], &snapshots[1], (MAX_SNAPSHOTS - 1) * sizeof(Snapshot));
+        snapshot_count--;
+    }
+
+    snapshots[snapshot_count] = snap;
+    snapshots[snapshot_count].id = next_snapshot_id++;
+    actions_since_snapshot = 0;
+    changes_since_snapshot = 0;
+
+    if (!automatic) {
+        printf("\nSNAPSHOT %d TAKEN (%d NEW PAGES, REST SHARED).\n",
+               snapshots[snapshot_count].id, snapshots[snapshot_count].new_pages);
+    }
+    snapshot_count++;
+}
+
+/* CALLED AFTER EVERY ADMIN ACTION, SNAPSHOTS ONLY WHEN SOMETHING CHANGED. THE PAGE
+   DIRTY FLAGS CANNOT TELL, THE BACKGROUND SAVE CLEARS THEM AFTER EVERY ACTION */
+void snapshot_tick() {
+    if (++actions_since_snapshot < SNAPSHOT_INTERVAL) return;
+
+    if (changes_since_snapshot > 0 || snapshot_count == 0) {
+        take_snapshot(1);
+    }
+}
+
+void snapshot_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("        SNAPSHOTS AND POINT-IN-TIME RESTORE\n");
+        printf("===============================================\n");
+        printf("1. TAKE SNAPSHOT NOW\n");
+        printf("2. LIST RETAINED SNAPSHOTS\n");
+        printf("3. RESTORE A SNAPSHOT\n");
+        printf("4. DIFF TWO SNAPSHOTS\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: take_snapshot(0); break;
+            case 2: list_snapshots(); break;
+            case 3: restore_snapshot(); break;
+            case 4: diff_snapshots(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+void list_snapshots() {
+    if (snapshot_count == 0) {
+        printf("\nNO SNAPSHOTS TAKEN YET.\n");
+        return;
+    }
+    printf("\nRETAINED SNAPSHOTS (LAST %d)\n", MAX_SNAPSHOTS);
+    print_line();
+    printf("| SNAP | TAKEN AT         | STUDENTS | TICKETS | PAGES | NEW PAGES |\n");
+    print_line();
+    for (int i = 0; i < snapshot_count; i++) {
+        char when[32];
+        format_time(snapshots[i].taken_at, when, sizeof(when));
+        printf("| %-4d | %-16s | %-8d | %-7d | %-5d | %-9d |\n",
+               snapshots[i].id, when,
+               snapshots[i].student_count, snapshots[i].ticket_count,
+               snapshots[i].student_page_count + snapshots[i].ticket_page_count,
+               snapshots[i].new_pages);
+    }
+    print_line();
+}
+
+/* COPIES BACK ONLY THE PAGES THAT DIFFER FROM THE LIVE STORES */
+void restore_snapshot() {
+    int i, copied = 0;
+    int archived_students = 0, archived_tickets = 0;
+    Snapshot *snap;
+
+    list_snapshots();
+    if (snapshot_count == 0) return;
+
+    i = find_snapshot(read_int("ENTER SNAPSHOT NUMBER TO RESTORE: "));
+    if (i == -1) {
+        printf("\nNO SUCH SNAPSHOT.\n");
+        return;
+    }
+    snap = &snapshots[i];
+    copied = restore_generation(snap, &archived_students, &archived_tickets);
+    if (copied < 0) {
+        printf("\nNOT ENOUGH MEMORY TO RESTORE. NOTHING WAS CHANGED.\n");
+        return;
+    }
+    printf("\nSNAPSHOT %d RESTORED (%d PAGES COPIED BACK).\n", snap->id, copied);
+    if (archived_students > 0 || archived_tickets > 0) {
+        printf("LEFT OUT %d STUDENTS AND %d ISSUES THAT HAVE SINCE BEEN MOVED TO %s.\n",
+               archived_students, archived_tickets, ARCHIVE_FILE);
+    }
+}
+
+/* COPIES THE SNAPSHOT BACK INTO THE LIVE STORES AND RETURNS THE NUMBER OF PAGES COPIED, OR
+   -1 (NOTHING CHANGED) IF MEMORY RUNS OUT. RECORDS ARCHIVED SINCE THE SNAPSHOT WAS TAKEN ARE
+   LEFT OUT SO THEY ARE NOT BOTH LIVE AND ARCHIVED; HOW MANY IS RETURNED IN archived_* */
+int restore_generation(Snapshot *snap, int *archived_students, int *archived_tickets) {
+    Snapshot base;
+    int copied = 0;
+
+    if (!copy_generation(&base, snap)) return -1;
+    for (int p = 0; p < snap->student_page_count; p++) {
+        SnapshotPage *page = snap->student_pages[p];
+        if (!student_page_dirty[p] && p < cow_base.student_page_count && cow_base.student_pages[p] == page) continue;
+        memcpy(&students[p * PAGE_RECORDS], page->data, page->records * sizeof(Student));
+        copied++;
+    }
+    for (int p = 0; p < snap->ticket_page_count; p++) {
+        SnapshotPage *page = snap->ticket_pages[p];
+        if (!ticket_page_dirty[p] && p < cow_base.ticket_page_count && cow_base.ticket_pages[p] == page) continue;
+        memcpy(&tickets[p * PAGE_RECORDS], page->data, page->records * sizeof(Ticket));
+        copied++;
+    }
+    student_count = snap->student_count;
+    ticket_count = snap->ticket_count;
+    /* TICKET IDS ARE NEVER HANDED OUT TWICE, EVEN AFTER GOING BACK IN TIME */
+    if (snap->next_ticket_id > next_ticket_id) next_ticket_id = snap->next_ticket_id;
+
+    /* LIVE STORES NOW MATCH THE SNAPSHOT, SO IT BECOMES THE COPY-ON-WRITE BASE */
+    release_generation(&cow_base);
+    cow_base = base;
+    memset(student_page_dirty, 0, sizeof(student_page_dirty));
+    memset(ticket_page_dirty, 0, sizeof(ticket_page_dirty));
+    drop_archived_records(archived_students, archived_tickets);
+
+    note_records_moved();
+    rebuild_room_occupancy();
+    rebuild_sla_stats();
+    note_store_change();
+    return copied;
+}
+
+/* REMOVES LIVE RECORDS WHOSE ID IS ALREADY IN THE ARCHIVE, MARKING THE SHIFTED PAGES DIRTY */
+void drop_archived_records(int *archived_students, int *archived_tickets) {
+    Student old_student;
+    Ticket old_ticket;
+    int kept = 0, first_moved = -1;
+
+    *archived_students = 0;
+    *archived_tickets = 0;
+    if (!archive_load_index()) return;
+
+    for (int i = 0; i < student_count; i++) {
+        if (archive_fetch(ARCHIVE_STUDENTS, students[i].id, &old_student)) {
+            if (first_moved == -1) first_moved = i;
+            (*archived_students)++;
+        } else {
+            students[kept++] = students[i];
+        }
+    }
+    student_count = kept;
+    if (first_moved != -1) {
+        for (int i = first_moved; i < MAX_STUDENTS; i += PAGE_RECORDS) mark_student_dirty(i);
+    }
+
+    kept = 0;
+    first_moved = -1;
+    for (int i = 0; i < ticket_count; i++) {
+        if (archive_fetch(ARCHIVE_TICKETS, tickets[i].ticket_id, &old_ticket)) {
+            if (first_moved == -1) first_moved = i;
+            (*archived_tickets)++;
+        } else {
+            tickets[kept++] = tickets[i];
+        }
+    }
+    ticket_count = kept;
+    if (first_moved != -1) {
+        for (int i = first_moved; i < MAX_TICKETS; i += PAGE_RECORDS) mark_ticket_dirty(i);
+    }
+}
+
+/* RECORDS OF BOTH TYPES START WITH THEIR INT ID */
+const void *snapshot_find_record(SnapshotPage **pages, int page_count, size_t record_size, int id) {
+    for (int p = 0; p < page_count; p++) {
+        for (int r = 0; r < pages[p]->records; r++) {
+            const unsigned char *rec = pages[p]->data + r * record_size;
+            if (*(const int *)rec == id) return rec;
+        }
+    }
+    return NULL;
+}
+
+/* PAGES SHARED BY BOTH SNAPSHOTS ARE SKIPPED WITHOUT LOOKING AT THEIR RECORDS */
+int diff_pages(SnapshotPage **old_pages, int old_count, SnapshotPage **new_pages, int new_count,
+               size_t record_size, int print_students) {
+    int changes = 0;
+
+    for (int p = 0; p < new_count; p++) {
+        if (p < old_count && old_pages[p] == new_pages[p]) continue;
+        for (int r = 0; r < new_pages[p]->records; r++) {
+            const unsigned char *rec = new_pages[p]->data + r * record_size;
+            const unsigned char *old = snapshot_find_record(old_pages, old_count, record_size, *(const int *)rec);
+            if (old != NULL && memcmp(old, rec, record_size) == 0) continue;
+
+            if (print_students) {
+                const Student *s = (const Student *)rec;
+                printf("%-8s STUDENT %-6d %s\n", old == NULL ? "ADDED" : "CHANGED", s->id, s->name);
+            } else {
+                const Ticket *t = (const Ticket *)rec;
+                printf("%-8s TICKET  %-6d %s%s%s\n", old == NULL ? "ADDED" : "CHANGED", t->ticket_id,
+                       old == NULL ? "" : ((const Ticket *)old)->status, old == NULL ? "" : " -> ", t->status);
+            }
+            changes++;
+        }
+    }
+    for (int p = 0; p < old_count; p++) {
+        if (p < new_count && old_pages[p] == new_pages[p]) continue;
+        for (int r = 0; r < old_pages[p]->records; r++) {
+            const unsigned char *rec = old_pages[p]->data + r * record_size;
+            if (snapshot_find_record(new_pages, new_count, record_size, *(const int *)rec) != NULL) continue;
+            printf("%-8s %s %-6d\n", "REMOVED", print_students ? "STUDENT" : "TICKET ", *(const int *)rec);
+            changes++;
+        }
+    }
+    return changes;
+}
+
+void diff_snapshots() {
+    int a, b, changes;
+
+    list_snapshots();
+    if (snapshot_count == 0) return;
+
+    a = find_snapshot(read_int("ENTER OLDER SNAPSHOT NUMBER: "));
+    b = find_snapshot(read_int("ENTER NEWER SNAPSHOT NUMBER: "));
+    if (a == -1 || b == -1) {
+        printf("\nNO SUCH SNAPSHOT.\n");
+        return;
+    }
+
+    printf("\nCHANGES FROM SNAPSHOT %d TO SNAPSHOT %d\n", snapshots[a].id, snapshots[b].id);
+    print_line();
+    changes = diff_pages(snapshots[a].student_pages, snapshots[a].student_page_count,
+                         snapshots[b].student_pages, snapshots[b].student_page_count, sizeof(Student), 1);
+    changes += diff_pages(snapshots[a].ticket_pages, snapshots[a].ticket_page_count,
+                          snapshots[b].ticket_pages, snapshots[b].ticket_page_count, sizeof(Ticket), 0);
+    print_line();
+    if (changes == 0) {
+        printf("\nNO DIFFERENCES.\n");
+    }
+}
+
+/* ---------------------- ARCHIVE (COMPRESSED, BLOCK-INDEXED) ---------------------- */
+
+/* fgets() LEAVES OLD BYTES AFTER THE TERMINATOR; ZEROING THEM (AND THE STRUCT
+   PADDING) TURNS EACH FIELD TAIL INTO A RUN THE COMPRESSOR CAN COLLAPSE */
+void normalize_record(void *record, size_t record_size, const TextField *fields, int field_count) {
+    unsigned char clean[sizeof(Student) > sizeof(Ticket) ? sizeof(Student) : sizeof(Ticket)];
+    unsigned char *raw = record;
+
+    memset(clean, 0, sizeof(clean));
+    /* LEADING INT ID AND EVERY NON-TEXT MEMBER ARE KEPT, TEXT IS COPIED UP TO ITS TERMINATOR */
+    memcpy(clean, raw, record_size);
+    for (int f = 0; f < field_count; f++) {
+        const unsigned char *end = memchr(raw + fields[f].offset, '\0', fields[f].size);
+        size_t len = end != NULL ? (size_t)(end - (raw + fields[f].offset)) : fields[f].size - 1;
+        memset(clean + fields[f].offset + len, 0, fields[f].size - len);
+    }
+    memcpy(raw, clean, record_size);
+}
+
+/* LZ77 WITH TWO TOKENS: 0x00-0x7F = 1-128 LITERAL BYTES FOLLOW,
+   0x80-0xFF = COPY 4-131 BYTES FROM A 16-BIT DISTANCE BACK (MAY OVERLAP, SO A
+   ZERO RUN BECOMES ONE LITERAL ZERO PLUS MATCHES AT DISTANCE 1) */
+int lz_compress(const unsigned char *in, int n, unsigned char *out) {
+    int head[1 << LZ_HASH_BITS];
+    int ip = 0, op = 0, literal_start = 0;
+
+    for (int h = 0; h < (1 << LZ_HASH_BITS); h++) head[h] = -1;
+
+    while (ip + LZ_MIN_MATCH <= n) {
+        unsigned int key = (unsigned int)in[ip] | (unsigned int)in[ip + 1] << 8 |
+                           (unsigned int)in[ip + 2] << 16 | (unsigned int)in[ip + 3] << 24;
+        int h = (int)((key * 2654435761u) >> (32 - LZ_HASH_BITS));
+        int candidate = head[h];
+        head[h] = ip;
+
+        if (candidate >= 0 && ip - candidate <= 0xFFFF && memcmp(in + candidate, in + ip, LZ_MIN_MATCH) == 0) {
+            int len = LZ_MIN_MATCH;
+            while (ip + len < n && len < LZ_MAX_MATCH && in[candidate + len] == in[ip + len]) len++;
+
+            while (literal_start < ip) {
+                int chunk = ip - literal_start > 128 ? 128 : ip - literal_start;
+                out[op++] = (unsigned char)(chunk - 1);
+                memcpy(out + op, in + literal_start, chunk);
+                op += chunk;
+                literal_start += chunk;
+            }
+            out[op++] = (unsigned char)(0x80 | (len - LZ_MIN_MATCH));
+            out[op++] = (unsigned char)((ip - candidate) & 0xFF);
+            out[op++] = (unsigned char)((ip - candidate) >> 8);
+            ip += len;
+            literal_start = ip;
+        } else {
+            ip++;
+        }
+    }
+    while (literal_start < n) {
+        int chunk = n - literal_start > 128 ? 128 : n - literal_start;
+        out[op++] = (unsigned char)(chunk - 1);
+        memcpy(out + op, in + literal_start, chunk);
+        op += chunk;
+        literal_start += chunk;
+    }
+    return op;
+}
+
+/* RETURNS THE UNPACKED SIZE, OR -1 IF THE DATA IS DAMAGED */
+int lz_decompress(const unsigned char *in, int n, unsigned char *out, int capacity) {
+    int ip = 0, op = 0;
+    while (ip < n) {
+        int token = in[ip++];
+        if (token < 0x80) {
+            int len = token + 1;
+            if (ip + len > n || op + len > capacity) return -1;
+            memcpy(out + op, in + ip, len);
+            ip += len;
+            op += len;
+        } else {
+            int len = (token & 0x7F) + LZ_MIN_MATCH;
+            int dist;
+            if (ip + 2 > n) return -1;
+            dist = in[ip] | in[ip + 1] << 8;
+            ip += 2;
+            if (dist == 0 || dist > op || op + len > capacity) return -1;
+            for (int i = 0; i < len; i++, op++) out[op] = out[op - dist];
+        }
+    }
+    return op;
+}
+
+int archive_load_index() {
+    FILE *fp;
+    if (archive_index_loaded) return archive_header.block_count > 0;
+
+    memset(&archive_header, 0, sizeof(archive_header));
+    free(archive_index);
+    archive_index = NULL;
+    archive_index_loaded = 1;
+    archive_damaged = 0;
+    fp = fopen(ARCHIVE_FILE, "rb");
+    if (fp == NULL) return 0;
+
+    if (!archive_read_index(fp, &archive_header, &archive_index)) {
+        memset(&archive_header, 0, sizeof(archive_header));
+        archive_damaged = 1;
+    }
+    fclose(fp);
+    return archive_header.block_count > 0;
+}
+
+/* READS THE HEADER AND BLOCK INDEX AND CHECKS THAT THEY DESCRIBE THE WHOLE FILE: EVERY
+   BLOCK INSIDE THE DATA AREA AND THE INDEX RIGHT AT THE END. RETURNS 0 OTHERWISE */
+int archive_read_index(FILE *fp, ArchiveHeader *header, ArchiveBlock **index) {
+    long file_size;
+
+    *index = NULL;
+    if (fread(header, sizeof(ArchiveHeader), 1, fp) != 1 || header->magic != ARCHIVE_MAGIC ||
+        header->block_count < 0 || header->index_offset < sizeof(ArchiveHeader) ||
+        header->student_records < 0 || header->ticket_records < 0 ||
+        fseek(fp, 0, SEEK_END) != 0 || (file_size = ftell(fp)) < 0 ||
+        header->index_offset + (unsigned long long)header->block_count * sizeof(ArchiveBlock) != (unsigned long long)file_size) {
+        return 0;
+    }
+
+    *index = malloc(header->block_count * sizeof(ArchiveBlock) + 1);
+    if (*index == NULL || fseek(fp, (long)header->index_offset, SEEK_SET) != 0 ||
+        fread(*index, sizeof(ArchiveBlock), header->block_count, fp) != (size_t)header->block_count) {
+        free(*index);
+        *index = NULL;
+        return 0;
+    }
+    for (int b = 0; b < header->block_count; b++) {
+        ArchiveBlock *blk = &(*index)[b];
+        if ((blk->kind != ARCHIVE_STUDENTS && blk->kind != ARCHIVE_TICKETS) ||
+            blk->records < 1 || blk->records > ARCHIVE_BLOCK_RECORDS || blk->min_id > blk->max_id ||
+            blk->offset < sizeof(ArchiveHeader) ||
+            (unsigned long long)blk->offset + blk->packed_size > header->index_offset) {
+            free(*index);
+            *index = NULL;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* BUILDS THE NEXT archive.dat IN MEMORY (HEADER, THE OLD BLOCKS AS THEY ARE, THE NEW BLOCKS,
+   THEN THE WHOLE INDEX) AND WRITES IT THROUGH A .tmp FILE, SO THE OLD ARCHIVE STAYS INTACT
+   UNTIL THE NEW ONE IS COMPLETE. THE INDEX IN MEMORY ONLY CHANGES ONCE THE FILE IS IN PLACE.
+   RETURNS 0 ON ANY FAILURE, AND REFUSES TO ADD TO AN ARCHIVE WHOSE INDEX COULD NOT BE READ */
+int archive_write(Student *old_students, int n_students, Ticket *old_tickets, int n_tickets) {
+    int new_blocks = (n_students + ARCHIVE_BLOCK_RECORDS - 1) / ARCHIVE_BLOCK_RECORDS +
+                     (n_tickets + ARCHIVE_BLOCK_RECORDS - 1) / ARCHIVE_BLOCK_RECORDS;
+    size_t raw_cap = ARCHIVE_BLOCK_RECORDS * (sizeof(Student) > sizeof(Ticket) ? sizeof(Student) : sizeof(Ticket));
+    size_t old_data, body_cap, pos;
+    unsigned char *body;
+    ArchiveBlock *index;
+    ArchiveHeader header;
+    int block_count, ok = 1;
+
+    archive_load_index();
+    if (archive_damaged) return 0;
+
+    header = archive_header;
+    if (header.magic != ARCHIVE_MAGIC) {
+        memset(&header, 0, sizeof(header));
+        header.magic = ARCHIVE_MAGIC;
+        header.index_offset = sizeof(ArchiveHeader);
+    }
+    block_count = header.block_count;
+    old_data = header.index_offset - sizeof(ArchiveHeader);
+    body_cap = old_data + new_blocks * (raw_cap + raw_cap / 128 + 16) + (block_count + new_blocks) * sizeof(ArchiveBlock);
+    body = malloc(body_cap);
+    index = malloc((block_count + new_blocks) * sizeof(ArchiveBlock) + 1);
+    if (body == NULL || index == NULL) {
+        free(body);
+        free(index);
+        return 0;
+    }
+    if (block_count > 0) memcpy(index, archive_index, block_count * sizeof(ArchiveBlock));
+
+    if (old_data > 0) {
+        FILE *fp = fopen(ARCHIVE_FILE, "rb");
+        ok = fp != NULL && fseek(fp, (long)sizeof(ArchiveHeader), SEEK_SET) == 0 &&
+             fread(body, 1, old_data, fp) == old_data;
+        if (fp != NULL) fclose(fp);
+    }
+    pos = old_data;
+
+    for (int kind = ARCHIVE_STUDENTS; kind <= ARCHIVE_TICKETS && ok; kind++) {
+        int count = kind == ARCHIVE_STUDENTS ? n_students : n_tickets;
+        size_t size = kind == ARCHIVE_STUDENTS ? sizeof(Student) : sizeof(Ticket);
+        unsigned char *base = kind == ARCHIVE_STUDENTS ? (unsigned char *)old_students : (unsigned char *)old_tickets;
+
+        for (int first = 0; first < count; first += ARCHIVE_BLOCK_RECORDS) {
+            ArchiveBlock *blk = &index[block_count++];
+            blk->kind = kind;
+            blk->records = count - first < ARCHIVE_BLOCK_RECORDS ? count - first : ARCHIVE_BLOCK_RECORDS;
+            blk->min_id = *(int *)(base + first * size);
+            blk->max_id = blk->min_id;
+            for (int r = 1; r < blk->records; r++) {
+                int id = *(int *)(base + (first + r) * size);
+                if (id < blk->min_id) blk->min_id = id;
+                if (id > blk->max_id) blk->max_id = id;
+            }
+            blk->offset = (unsigned int)(sizeof(ArchiveHeader) + pos);
+            blk->packed_size = (unsigned int)lz_compress(base + first * size, (int)(blk->records * size), body + pos);
+            pos += blk->packed_size;
+        }
+    }
+
+    header.block_count = block_count;
+    header.index_offset = (unsigned int)(sizeof(ArchiveHeader) + pos);
+    header.student_records += n_students;
+    header.ticket_records += n_tickets;
+    memcpy(body + pos, index, block_count * sizeof(ArchiveBlock));
+    pos += block_count * sizeof(ArchiveBlock);
+
+    /* OFFSETS ARE 32-BIT AND write_file_replace() TAKES AN int COUNT */
+    ok = ok && pos <= INT_MAX - sizeof(ArchiveHeader) &&
+         write_file_replace(ARCHIVE_FILE, &header, sizeof(header), body, 1, (int)pos);
+    free(body);
+    if (!ok) {
+        free(index);
+        return 0;
+    }
+    free(archive_index);
+    archive_index = index;
+    archive_header = header;
+    return 1;
+}
+
+/* INDEX RANGES PICK THE BLOCKS THAT CAN HOLD THE ID; ONLY THOSE ARE READ AND UNPACKED */
+int archive_fetch(int kind, int id, void *out) {
+    size_t size = kind == ARCHIVE_STUDENTS ? sizeof(Student) : sizeof(Ticket);
+    unsigned char *packed, *raw;
+    int found = 0;
+    FILE *fp;
+
+    if (!archive_load_index()) return 0;
+
+    fp = fopen(ARCHIVE_FILE, "rb");
+    raw = malloc(ARCHIVE_BLOCK_RECORDS * size);
+    packed = NULL;
+    if (fp == NULL || raw == NULL) {
+        if (fp != NULL) fclose(fp);
+        free(raw);
+        return 0;
+    }
+
+    for (int b = 0; b < archive_header.block_count && !found; b++) {
+        ArchiveBlock *blk = &archive_index[b];
+        unsigned char *grown;
+        int unpacked;
+
+        if (blk->kind != kind || id < blk->min_id || id > blk->max_id) continue;
+
+        grown = realloc(packed, blk->packed_size + 1);
+        if (grown == NULL) break;
+        packed = grown;
+        if (fseek(fp, (long)blk->offset, SEEK_SET) != 0 ||
+            fread(packed, 1, blk->packed_size, fp) != blk->packed_size) continue;
+
+        unpacked = lz_decompress(packed, (int)blk->packed_size, raw, (int)(ARCHIVE_BLOCK_RECORDS * size));
+        for (int r = 0; r * (int)size < unpacked; r++) {
+            if (*(int *)(raw + r * size) == id) {
+                memcpy(out, raw + r * size, size);
+                found = 1;
+                break;
+            }
+        }
+    }
+
+    fclose(fp);
+    free(packed);
+    free(raw);
+    return found;
+}
+
+int compare_student_ids(const void *a, const void *b) {
+    int x = ((const Student *)a)->id, y = ((const Student *)b)->id;
+    return (x > y) - (x < y);
+}
+
+void archive_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("              ARCHIVE OLD RECORDS\n");
+        printf("===============================================\n");
+        printf("1. MOVE INACTIVE STUDENTS AND OLD RESOLVED ISSUES TO ARCHIVE\n");
+        printf("2. SEARCH ARCHIVED STUDENT BY ID\n");
+        printf("3. SEARCH ARCHIVED ISSUE BY TICKET ID\n");
+        printf("4. ARCHIVE SUMMARY\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: archive_old_records(); break;
+            case 2: search_archived_student(); break;
+            case 3: search_archived_ticket(); break;
+            case 4: archive_summary(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+    } while (choice != 0);
+}
+
+/* MOVED RECORDS ARE COPIED OUT, NORMALIZED AND WRITTEN AS COMPRESSED BLOCKS; ONLY
+   THEN DO THE KEPT RECORDS SLIDE DOWN IN PLACE, ONE PASS PER STORE */
+void archive_old_records() {
+    unsigned int now = (unsigned int)time(NULL);
+    unsigned int cutoff = now > ARCHIVE_AFTER_DAYS * SECONDS_PER_DAY ? now - ARCHIVE_AFTER_DAYS * SECONDS_PER_DAY : 0;
+    Student *old_students = malloc(student_count * sizeof(Student) + 1);
+    Ticket *old_tickets = malloc(ticket_count * sizeof(Ticket) + 1);
+    int n_students = 0, n_tickets = 0, kept = 0;
+    int first_moved_student = -1, first_moved_ticket = -1;
+
+    if (old_students == NULL || old_tickets == NULL) {
+        printf("\nNOT ENOUGH MEMORY TO ARCHIVE.\n");
+        free(old_students);
+        free(old_tickets);
+        return;
+    }
+
+    for (int i = 0; i < student_count; i++) {
+        if (!students[i].is_active) {
+            if (first_moved_student == -1) first_moved_student = i;
+            old_students[n_students] = students[i];
+            normalize_record(&old_students[n_students++], sizeof(Student),
+                             student_text_fields, sizeof(student_text_fields) / sizeof(TextField));
+        }
+    }
+
+    for (int i = 0; i < ticket_count; i++) {
+        Ticket *t = &tickets[i];
+        if (ticket_status_code(t->status) == TICKET_RESOLVED && t->resolved_at <= cutoff) {
+            if (first_moved_ticket == -1) first_moved_ticket = i;
+            old_tickets[n_tickets] = *t;
+            normalize_record(&old_tickets[n_tickets++], sizeof(Ticket),
+                             ticket_text_fields, sizeof(ticket_text_fields) / sizeof(TextField));
+        }
+    }
+
+    archive_load_index();
+    if (archive_damaged) {
+        printf("\n%s COULD NOT BE READ. NOTHING ARCHIVED; MOVE THE FILE ASIDE TO START A NEW ARCHIVE.\n", ARCHIVE_FILE);
+        free(old_students);
+        free(old_tickets);
+        return;
+    }
+
+    if (n_students == 0 && n_tickets == 0) {
+        printf("\nNOTHING TO ARCHIVE.\n");
+        free(old_students);
+        free(old_tickets);
+        return;
+    }
+
+    /* TIGHT ID RANGES PER BLOCK KEEP LOOKUPS TO ONE BLOCK; TICKETS ARE ALREADY IN ID ORDER */
+    qsort(old_students, n_students, sizeof(Student), compare_student_ids);
+
+    if (!archive_write(old_students, n_students, old_tickets, n_tickets)) {
+        printf("\nUNABLE TO WRITE ARCHIVE FILE. NOTHING ARCHIVED.\n");
+        free(old_students);
+        free(old_tickets);
+        return;
+    }
+
+    for (int i = 0; i < student_count; i++) {
+        if (students[i].is_active) {
+            students[kept++] = students[i];
+        }
+    }
+    student_count = kept;
+    kept = 0;
+    for (int i = 0; i < ticket_count; i++) {
+        Ticket *t = &tickets[i];
+        if (ticket_status_code(t->status) == TICKET_RESOLVED && t->resolved_at <= cutoff) {
+            sla_track_resolution(t, -1);
+        } else {
+            tickets[kept++] = *t;
+        }
+    }
+    ticket_count = kept;
+    note_records_moved();
+
+    /* EVERY PAGE FROM THE FIRST REMOVED RECORD ONWARD HAS SHIFTED */
+    if (first_moved_student != -1) {
+        for (int i = first_moved_student; i < MAX_STUDENTS; i += PAGE_RECORDS) mark_student_dirty(i);
+    }
+    if (first_moved_ticket != -1) {
+        for (int i = first_moved_ticket; i < MAX_TICKETS; i += PAGE_RECORDS) mark_ticket_dirty(i);
+    }
+
+    printf("\nARCHIVED %d STUDENTS AND %d ISSUES TO %s.\n", n_students, n_tickets, ARCHIVE_FILE);
+    free(old_students);
+    free(old_tickets);
+}
+
+void archive_summary() {
+    unsigned long long raw = 0, packed = 0;
+
+    if (!archive_load_index()) {
+        printf("\nARCHIVE IS EMPTY.\n");
+        return;
+    }
+    for (int b = 0; b < archive_header.block_count; b++) {
+        ArchiveBlock *blk = &archive_index[b];
+        raw += (unsigned long long)blk->records * (blk->kind == ARCHIVE_STUDENTS ? sizeof(Student) : sizeof(Ticket));
+        packed += blk->packed_size;
+    }
+
+    printf("\n=================== ARCHIVE SUMMARY ===================\n");
+    printf("ARCHIVED STUDENTS       : %d\n", archive_header.student_records);
+    printf("ARCHIVED ISSUES         : %d\n", archive_header.ticket_records);
+    printf("COMPRESSED BLOCKS       : %d\n", archive_header.block_count);
+    printf("ORIGINAL SIZE (BYTES)   : %llu\n", raw);
+    printf("ARCHIVE SIZE (BYTES)    : %llu\n", packed);
+    printf("=======================================================\n");
+}
+
+void search_archived_student() {
+    Student s;
+    int id = read_int("ENTER STUDENT ID: ");
+    if (!archive_fetch(ARCHIVE_STUDENTS, id, &s)) {
+        printf("\nSTUDENT NOT FOUND IN ARCHIVE.\n");
+        return;
+    }
+    print_student_table_header();
+    print_student_row(s);
+    print_line();
+}
+
+void search_archived_ticket() {
+    Ticket t;
+    int tid = read_int("ENTER TICKET ID: ");
+    if (!archive_fetch(ARCHIVE_TICKETS, tid, &t)) {
+        printf("\nTICKET NOT FOUND IN ARCHIVE.\n");
+        return;
+    }
+    print_ticket_details(&t);
+}
+
+/* ---------------------- GATE ENTRY / EXIT LOG ---------------------- */
+
+void gate_menu() {
+    int choice;
+    do {
+        printf("\n===============================================\n");
+        printf("            GATE ENTRY / EXIT LOG\n");
+        printf("===============================================\n");
+        printf("1. RECORD CHECK-OUT (LEAVING THE HOSTEL)\n");
+        printf("2. RECORD CHECK-IN (BACK IN THE HOSTEL)\n");
+        printf("3. IMPORT GATE SCANNER FILE (%s)\n", GATE_IMPORT_FILE);
+        printf("4. WHO IS OUTSIDE NOW\n");
+        printf("5. STUDENT MOVEMENTS THIS WEEK\n");
+        printf("6. CURFEW VIOLATION REPORT\n");
+        printf("0. BACK TO ADMIN MENU\n");
+        printf("===============================================\n");
+        choice = read_int("ENTER YOUR CHOICE: ");
+
+        switch (choice) {
+            case 1: record_gate_event(GATE_OUT); break;
+            case 2: record_gate_event(GATE_IN); break;
+            case 3: import_gate_events(); break;
+            case 4: view_students_outside(); break;
+            case 5: view_student_movements(); break;
+            case 6: curfew_report(); break;
+            case 0: break;
+            default: printf("\nINVALID CHOICE. PLEASE TRY AGAIN.\n");
+        }
+
+        /* SCANS ARE BATCHED WHILE AN IMPORT RUNS; WHATEVER IS LEFT GOES TO DISK HERE */
+        if (!gate_flush()) {
+            printf("\nWARNING: GATE LOG COULD NOT BE WRITTEN. %d EVENTS WILL BE RETRIED.\n", gate_batch_count);
+        }
+    } while (choice != 0);
+}
+
+void record_gate_event(int direction) {
+    unsigned int now = (unsigned int)time(NULL);
+    int id = read_int("ENTER STUDENT ID: ");
+    int was_outside = gate_is_outside(id);
+    const char *why = gate_record(id, direction, now > gate_last_event ? now : gate_last_event);
+
+    if (why != NULL) {
+        printf("\nNOT RECORDED: %s.\n", why);
+        return;
+    }
+    printf("\nCHECK-%s RECORDED FOR STUDENT %d.\n", direction == GATE_OUT ? "OUT" : "IN", id);
+    if (direction == GATE_IN && !was_outside) {
+        printf("NOTE: THERE WAS NO CHECK-OUT ON RECORD FOR THIS STUDENT.\n");
+    }
+}
+
+/* EACH LINE: STUDENT_ID,IN OR OUT[,UNIX TIME]. LINES MUST BE IN TIME ORDER; A LINE WITH NO
+   TIME IS TAKEN AS NOW */
+void import_gate_events() {
+    unsigned int now = (unsigned int)time(NULL);
+    int accepted = 0, refused = 0, bad = 0, line_no = 0;
+    char line[128];
+    FILE *fp = fopen(GATE_IMPORT_FILE, "r");
+
+    if (fp == NULL) {
+        printf("\n%s NOT FOUND. EACH LINE SHOULD BE: STUDENT_ID,IN OR OUT[,UNIX TIME]\n", GATE_IMPORT_FILE);
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char direction[8];
+        unsigned int at;
+        int id, fields, code;
+        const char *why;
+
+        line_no++;
+        if (line[strspn(line, " \t\r\n")] == '\0') continue;
+        fields = sscanf(line, "%d , %7[A-Za-z] , %u", &id, direction, &at);
+        for (char *p = direction; fields >= 2 && *p != '\0'; p++) {
+            if (*p >= 'a' && *p <= 'z') *p = (char)(*p - 'a' + 'A');
+        }
+        code = fields < 2 ? -1 : strcmp(direction, "OUT") == 0 ? GATE_OUT : strcmp(direction, "IN") == 0 ? GATE_IN : -1;
+        if (code == -1) {
+            if (bad++ < 5) printf("LINE %d IGNORED: NOT IN THE FORM STUDENT_ID,IN OR OUT[,TIME]\n", line_no);
+            continue;
+        }
+        if (fields < 3) at = now > gate_last_event ? now : gate_last_event;
+
+        why = gate_record(id, code, at);
+        if (why == NULL) {
+            accepted++;
+        } else if (refused++ < 5) {
+            printf("LINE %d REFUSED: %s\n", line_no, why);
+        }
+    }
+    fclose(fp);
+
+    printf("\nIMPORT FINISHED: %d EVENTS LOGGED, %d REFUSED, %d LINES NOT UNDERSTOOD.\n", accepted, refused, bad);
+}
+
+void view_students_outside() {
+    unsigned int now = (unsigned int)time(NULL);
+    char block[10];
+    int shown = 0;
+
+    read_string("ENTER HOSTEL BLOCK (EMPTY = ALL BLOCKS): ", block, sizeof(block));
+    printf("\nSTUDENTS OUTSIDE THE HOSTEL NOW\n");
+    print_line();
+    printf("| ID     | NAME                 | BLOCK      | WENT OUT         | HOURS |\n");
+    print_line();
+    for (int i = 0; i < gate_outside_count; i++) {
+        GateOutside *o = &gate_outside[i];
+        int index = find_student_by_id(o->student_id);
+        char when[32];
+
+        if (block[0] != '\0' && strcmp(o->hostel_block, block) != 0) continue;
+        format_time(o->since, when, sizeof(when));
+        printf("| %-6d | %-20s | %-10s | %-16s | %-5u |\n", o->student_id,
+               index == -1 ? "(NOT ON ROLL)" : students[index].name, o->hostel_block, when,
+               now > o->since ? (now - o->since) / 3600 : 0);
+        shown++;
+    }
+    print_line();
+    printf("TOTAL OUTSIDE: %d\n", shown);
+}
+
+void print_movement(const GateEvent *e, void *arg) {
+    MovementScan *scan = arg;
+    char when[32];
+
+    if (e->student_id != scan->student_id) return;
+    format_time(e->at, when, sizeof(when));
+    if (e->direction == GATE_OUT) {
+        printf("%s  OUT  %-10s\n", when, e->hostel_block);
+        scan->last_out = e->at;
+    } else if (scan->last_out != 0) {
+        unsigned int away = e->at - scan->last_out;
+        printf("%s  IN   %-10s (AWAY %uH %02uM)\n", when, e->hostel_block, away / 3600, away % 3600 / 60);
+        scan->last_out = 0;
+    } else {
+        printf("%s  IN   %-10s\n", when, e->hostel_block);
+    }
+    scan->shown++;
+}
+
+/* ONLY THE LAST GATE_WEEK_DAYS DAY FILES ARE OPENED */
+void view_student_movements() {
+    unsigned int now = (unsigned int)time(NULL);
+    MovementScan scan;
+    int index;
+
+    memset(&scan, 0, sizeof(scan));
+    scan.student_id = read_int("ENTER STUDENT ID: ");
+    index = find_student_by_id(scan.student_id);
+    if (index == -1) {
+        printf("\nSTUDENT ID NOT FOUND.\n");
+        return;
+    }
+
+    printf("\nGATE MOVEMENTS OF %s (ID %d), LAST %d DAYS\n", students[index].name, scan.student_id, GATE_WEEK_DAYS);
+    print_line();
+    gate_scan(now - GATE_WEEK_DAYS * SECONDS_PER_DAY, now + GATE_CLOCK_SLACK + 1, 0, print_movement, &scan);
+    print_line();
+    if (scan.shown == 0) printf("NO GATE MOVEMENTS IN THE LAST %d DAYS.\n", GATE_WEEK_DAYS);
+    if (gate_is_outside(scan.student_id)) {
+        char when[32];
+        format_time(gate_outside[gate_set_find(gate_outside, gate_outside_count, scan.student_id)].since,
+                    when, sizeof(when));
+        printf("CURRENTLY OUTSIDE SINCE %s.\n", when);
+    }
+}
+
+void print_curfew_row(int student_id, const char *block, unsigned int out_at, unsigned int back_at, const char *note) {
+    int index = find_student_by_id(student_id);
+    char went[32] = "-", back[32] = "NOT BACK";
+
+    if (out_at != 0) format_time(out_at, went, sizeof(went));
+    if (back_at != 0) format_time(back_at, back, sizeof(back));
+    printf("| %-6d | %-20s | %-10s | %-16s | %-16s | %s\n", student_id,
+           index == -1 ? "(NOT ON ROLL)" : students[index].name, block, went, back, note);
+}
+
+/* WALKS ONE DAY FROM THE MORNING: OUT OPENS AN ENTRY, IN CLOSES IT. AN ENTRY STILL OPEN AT
+   CURFEW, OR ONE OPENED DURING CURFEW, IS A VIOLATION. AN IN WITH NO ENTRY TO CLOSE MEANS
+   THE STUDENT WAS ALREADY AWAY THAT MORNING, SO IT IS A RETURN FROM LEAVE */
+void curfew_visit(const GateEvent *e, void *arg) {
+    CurfewScan *scan = arg;
+    int pos;
+
+    if (scan->hostel_block[0] != '\0' && strcmp(e->hostel_block, scan->hostel_block) != 0) return;
+    pos = gate_set_find(scan->open, scan->open_count, e->student_id);
+    if (e->direction == GATE_IN && e->at >= scan->curfew_start &&
+        pos < scan->open_count && scan->open[pos].student_id == e->student_id) {
+        GateOutside *o = &scan->open[pos];
+        print_curfew_row(e->student_id, e->hostel_block, o->since, e->at,
+                         o->since < scan->curfew_start ? "BACK AFTER CURFEW" : "WENT OUT DURING CURFEW");
+        scan->violations++;
+    }
+    gate_set_apply(scan->open, &scan->open_count, MAX_STUDENTS, e);
+}
+
+/* THE NIGHT OF DATE D RUNS FROM GATE_CURFEW_HOUR ON D TO GATE_CURFEW_END_HOUR ON D + 1.
+   STUDENTS AWAY SINCE BEFORE GATE_CURFEW_END_HOUR ON D ARE ON LEAVE: THEY HAVE NO ENTRY IN
+   scan.open, SO NEITHER THEIR RETURN NOR THEIR ABSENCE IS REPORTED */
+void curfew_report() {
+    char date[16];
+    int day, month, year;
+    unsigned int morning, night_end;
+    CurfewScan scan;
+
+    read_string("ENTER NIGHT DATE (DD/MM/YYYY, EMPTY = LAST NIGHT): ", date, sizeof(date));
+    if (date[0] == '\0') {
+        time_t raw = time(NULL);
+        struct tm *tm_info = localtime(&raw);
+        if (tm_info == NULL) return;
+        if (tm_info->tm_hour < GATE_CURFEW_HOUR) {
+            raw -= SECONDS_PER_DAY;
+            tm_info = localtime(&raw);
+            if (tm_info == NULL) return;
+        }
+        day = tm_info->tm_mday;
+        month = tm_info->tm_mon + 1;
+        year = tm_info->tm_year + 1900;
+    } else if (sscanf(date, "%d/%d/%d", &day, &month, &year) != 3 || day < 1 || day > 31 ||
+               month < 1 || month > 12 || year < 1970 || year > 2105) {
+        printf("\nINVALID DATE. USE DD/MM/YYYY.\n");
+        return;
+    }
+
+    memset(&scan, 0, sizeof(scan));
+    read_string("ENTER HOSTEL BLOCK (EMPTY = ALL BLOCKS): ", scan.hostel_block, sizeof(scan.hostel_block));
+    morning = local_time_at(day, month, year, GATE_CURFEW_END_HOUR);
+    scan.curfew_start = local_time_at(day, month, year, GATE_CURFEW_HOUR);
+    night_end = local_time_at(day + 1, month, year, GATE_CURFEW_END_HOUR);
+    scan.open = malloc(MAX_STUDENTS * sizeof(GateOutside));
+    if (scan.open == NULL || morning == 0 || night_end <= morning) {
+        free(scan.open);
+        printf("\nCANNOT WORK OUT THE CURFEW HOURS FOR THAT DATE.\n");
+        return;
+    }
+
+    printf("\nCURFEW VIOLATIONS, NIGHT OF %02d/%02d/%04d (%02d:00 - %02d:00)\n", day, month, year,
+           GATE_CURFEW_HOUR, GATE_CURFEW_END_HOUR);
+    print_line();
+    printf("| ID     | NAME                 | BLOCK      | WENT OUT         | CAME BACK        | NOTE\n");
+    print_line();
+    gate_scan(morning, night_end, scan.hostel_block[0] != '\0' ? gate_block_bit(scan.hostel_block) : 0,
+              curfew_visit, &scan);
+    for (int i = 0; i < scan.open_count; i++) {
+        GateOutside *o = &scan.open[i];
+        print_curfew_row(o->student_id, o->hostel_block, o->since, 0,
+                         o->since < scan.curfew_start ? "NOT BACK BY MORNING" : "WENT OUT DURING CURFEW");
+        scan.violations++;
+    }
+    print_line();
+    printf("TOTAL VIOLATIONS: %d\n", scan.violations);
+    free(scan.open);
+}
+
+/* LOCAL TIME AT hour:00 ON THE DATE; mktime() CARRIES day = 32 INTO THE NEXT MONTH */
+unsigned int local_time_at(int day, int month, int year, int hour) {
+    struct tm tm_info;
+    time_t t;
+
+    memset(&tm_info, 0, sizeof(tm_info));
+    tm_info.tm_mday = day;
+    tm_info.tm_mon = month - 1;
+    tm_info.tm_year = year - 1900;
+    tm_info.tm_hour = hour;
+    tm_info.tm_isdst = -1;
+    t = mktime(&tm_info);
+    return t == (time_t)-1 || t < 0 ? 0 : (unsigned int)t;
+}
+
+int gate_day(unsigned int t) {
+    return (int)(t / SECONDS_PER_DAY);
+}
+
+void gate_file_name(char *path, int size, int day) {
+    time_t raw = (time_t)day * SECONDS_PER_DAY;
+    struct tm *tm_info = gmtime(&raw);
+    if (tm_info == NULL) {
+        snprintf(path, size, "gate_day_%d.dat", day);
+        return;
+    }
+    snprintf(path, size, GATE_FILE, tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday);
+}
+
+/* ONE OF 32 BITS FOR A BLOCK NAME. TWO BLOCKS MAY SHARE A BIT, SO A SET BIT ONLY MEANS
+   THE SEGMENT MAY HOLD THAT BLOCK */
+unsigned int gate_block_bit(const char *block) {
+    unsigned int h = 2166136261u;
+    for (; *block != '\0'; block++) h = (h ^ (unsigned char)*block) * 16777619u;
+    return 1u << (h % 32);
+}
+
+/* POSITION OF student_id IN A SET SORTED BY STUDENT ID, OR WHERE IT WOULD GO */
+int gate_set_find(GateOutside *set, int count, int student_id) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (set[mid].student_id < student_id) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* IN REMOVES THE STUDENT, OUT ADDS THEM (A SECOND OUT AFTER A MISSED IN SCAN MOVES THE TIME
+   UP). THE RESULT DEPENDS ONLY ON EACH STUDENT'S LAST EVENT, SO APPLYING EVENTS AGAIN IN
+   ORDER IS HARMLESS */
+void gate_set_apply(GateOutside *set, int *count, int capacity, const GateEvent *e) {
+    int pos = gate_set_find(set, *count, e->student_id);
+    int present = pos < *count && set[pos].student_id == e->student_id;
+
+    if (e->direction == GATE_IN) {
+        if (present) {
+            memmove(&set[pos], &set[pos + 1], (*count - pos - 1) * sizeof(GateOutside));
+            (*count)--;
+        }
+        return;
+    }
+    if (!present) {
+        if (*count >= capacity) return;
+        memmove(&set[pos + 1], &set[pos], (*count - pos) * sizeof(GateOutside));
+        (*count)++;
+    }
+    memset(&set[pos], 0, sizeof(GateOutside));
+    set[pos].student_id = e->student_id;
+    set[pos].since = e->at;
+    memcpy(set[pos].hostel_block, e->hostel_block, sizeof(set[pos].hostel_block));
+}
+
+int gate_is_outside(int student_id) {
+    int pos = gate_set_find(gate_outside, gate_outside_count, student_id);
+    return pos < gate_outside_count && gate_outside[pos].student_id == student_id;
+}
+
+/* THE SET IS FULL ONLY IF IT STILL HOLDS STUDENTS WHO HAVE SINCE LEFT THE ROLL */
+void gate_prune_outside() {
+    int kept = 0;
+    for (int i = 0; i < gate_outside_count; i++) {
+        if (find_student_by_id(gate_outside[i].student_id) != -1) gate_outside[kept++] = gate_outside[i];
+    }
+    gate_outside_count = kept;
+}
+
+/* CHECKS AND QUEUES ONE SCAN, USING THE SAME ID CHECK AS EVERY OTHER MENU. THE LOG ONLY
+   MOVES FORWARD IN TIME. RETURNS NULL, OR WHY THE EVENT WAS REFUSED */
+const char *gate_record(int student_id, int direction, unsigned int at) {
+    unsigned int now = (unsigned int)time(NULL);
+    int index = find_student_by_id(student_id);
+    GateEvent *e;
+
+    if (index == -1) return "STUDENT ID NOT FOUND";
+    if (!students[index].is_active) return "STUDENT IS NOT ACTIVE";
+    if (at < gate_last_event) return "OLDER THAN THE LAST LOGGED EVENT";
+    if (at > now + GATE_CLOCK_SLACK) return "TIME IS IN THE FUTURE";
+    if (gate_batch_count == GATE_BATCH_EVENTS && !gate_flush()) return "GATE LOG COULD NOT BE WRITTEN";
+
+    e = &gate_batch[gate_batch_count++];
+    memset(e, 0, sizeof(GateEvent));
+    e->student_id = student_id;
+    e->at = at;
+    e->direction = (char)direction;
+    strcpy(e->hostel_block, students[index].hostel_block);
+    gate_last_event = at;
+
+    if (direction == GATE_OUT && gate_outside_count == MAX_STUDENTS) gate_prune_outside();
+    gate_set_apply(gate_outside, &gate_outside_count, MAX_STUDENTS, e);
+    if (gate_batch_count == GATE_BATCH_EVENTS) gate_flush();
+    return NULL;
+}
+
+/* APPENDS THE QUEUED EVENTS AS ONE SEGMENT PER DAY THEY SPAN, THEN SAVES THE OUTSIDE SET
+   WITH THE NEW END OF THE LOG. A FAILED APPEND IS CUT BACK OFF THE FILE AND THE EVENTS
+   STAY QUEUED */
+int gate_flush() {
+    int first = 0;
+
+    while (first < gate_batch_count) {
+        int day = gate_day(gate_batch[first].at), end = first, ok;
+        GateSegmentHeader header;
+        char path[64];
+        long start;
+        FILE *fp;
+
+        memset(&header, 0, sizeof(header));
+        header.magic = GATE_MAGIC;
+        header.min_time = gate_batch[first].at;
+        for (; end < gate_batch_count && gate_day(gate_batch[end].at) == day; end++) {
+            header.block_mask |= gate_block_bit(gate_batch[end].hostel_block);
+            header.max_time = gate_batch[end].at;
+        }
+        header.event_count = end - first;
+
+        gate_file_name(path, sizeof(path), day);
+        fp = fopen(path, "ab");
+        if (fp == NULL) break;
+        fseek(fp, 0, SEEK_END);
+        start = ftell(fp);
+        ok = start >= 0 && fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(&gate_batch[first], sizeof(GateEvent), header.event_count, fp) == (size_t)header.event_count;
+        ok = fclose(fp) == 0 && ok;
+        if (!ok) {
+            if (start >= 0) gate_cut_file(path, start);
+            break;
+        }
+        gate_tail_day = day;
+        gate_tail_offset = (unsigned int)start + sizeof(header) + header.event_count * sizeof(GateEvent);
+        first = end;
+    }
+
+    memmove(gate_batch, &gate_batch[first], (gate_batch_count - first) * sizeof(GateEvent));
+    gate_batch_count -= first;
+    /* THE SET ON DISK MUST NOT GET AHEAD OF THE LOG */
+    if (first > 0 && gate_batch_count == 0) gate_write_outside();
+    return gate_batch_count == 0;
+}
+
+/* KEEPS ONLY THE FIRST length BYTES OF A SEGMENT FILE */
+void gate_cut_file(const char *path, long length) {
+    char tmp_path[64], buffer[4096];
+    FILE *in = fopen(path, "rb"), *out;
+    int ok = 1;
+
+    if (in == NULL) return;
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    out = fopen(tmp_path, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return;
+    }
+    while (length > 0 && ok) {
+        size_t chunk = length < (long)sizeof(buffer) ? (size_t)length : sizeof(buffer);
+        ok = fread(buffer, 1, chunk, in) == chunk && fwrite(buffer, 1, chunk, out) == chunk;
+        length -= (long)chunk;
+    }
+    fclose(in);
+    ok = fclose(out) == 0 && ok;
+    if (ok) replace_file(tmp_path, path);
+    else remove(tmp_path);
+}
+
+int gate_write_outside() {
+    GateOutsideHeader header;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = GATE_OUTSIDE_MAGIC;
+    header.version = 1;
+    header.count = gate_outside_count;
+    header.through_day = gate_tail_day >= 0 ? gate_tail_day : gate_day(gate_last_event);
+    header.through_offset = gate_tail_day >= 0 ? gate_tail_offset : 0;
+    header.last_event = gate_last_event;
+    return write_file_replace(GATE_OUTSIDE_FILE, &header, sizeof(header), gate_outside,
+                              sizeof(GateOutside), gate_outside_count);
+}
+
+/* READS AND CHECKS A SEGMENT HEADER. FALSE AT THE END OF THE FILE OR AT A DAMAGED SEGMENT */
+int gate_read_header(FILE *fp, GateSegmentHeader *header) {
+    return fread(header, sizeof(GateSegmentHeader), 1, fp) == 1 && header->magic == GATE_MAGIC &&
+           header->event_count >= 1 && header->event_count <= GATE_BATCH_EVENTS &&
+           header->min_time <= header->max_time;
+}
+
+/* READS A SEGMENT'S EVENTS. EACH MUST LIE IN THE HEADER'S TIME RANGE, IN TIME ORDER, WITH
+   ITS BLOCK BIT IN THE MASK */
+int gate_read_events(FILE *fp, const GateSegmentHeader *header, GateEvent *events) {
+    if (fread(events, sizeof(GateEvent), header->event_count, fp) != (size_t)header->event_count) return 0;
+    for (int i = 0; i < header->event_count; i++) {
+        GateEvent *e = &events[i];
+        e->hostel_block[sizeof(e->hostel_block) - 1] = '\0';
+        if (e->at < header->min_time || e->at > header->max_time || (i > 0 && e->at < events[i - 1].at) ||
+            (e->direction != GATE_OUT && e->direction != GATE_IN) ||
+            !(header->block_mask & gate_block_bit(e->hostel_block))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* CALLS visit FOR EVERY LOGGED EVENT WITH from <= at < to, OLDEST FIRST. ONLY THE DAY FILES
+   OF THE RANGE ARE OPENED, AND SEGMENTS OUTSIDE THE RANGE OR WITHOUT A BIT OF block_mask
+   (0 = ANY BLOCK) ARE SKIPPED WITHOUT READING THEIR EVENTS */
+void gate_scan(unsigned int from, unsigned int to, unsigned int block_mask,
+               void (*visit)(const GateEvent *e, void *arg), void *arg) {
+    static GateEvent events[GATE_BATCH_EVENTS];
+
+    gate_flush();
+    if (to <= from) return;
+    for (int day = gate_day(from); day <= gate_day(to - 1); day++) {
+        GateSegmentHeader header;
+        char path[64];
+        FILE *fp;
+
+        gate_file_name(path, sizeof(path), day);
+        fp = fopen(path, "rb");
+        if (fp == NULL) continue;
+        while (gate_read_header(fp, &header) && header.min_time < to) {
+            if (header.max_time < from || (block_mask != 0 && !(header.block_mask & block_mask))) {
+                if (fseek(fp, (long)(header.event_count * sizeof(GateEvent)), SEEK_CUR) != 0) break;
+                continue;
+            }
+            if (!gate_read_events(fp, &header, events)) break;
+            for (int i = 0; i < header.event_count; i++) {
+                if (events[i].at >= from && events[i].at < to) visit(&events[i], arg);
+            }
+        }
+        fclose(fp);
+    }
+}
+
+/* gate_outside.dat: COUNT IN RANGE, IDS STRICTLY ASCENDING, TEXT TERMINATED */
+int gate_read_outside(FILE *fp, GateOutsideHeader *header) {
+    if (fread(header, sizeof(GateOutsideHeader), 1, fp) != 1 || header->magic != GATE_OUTSIDE_MAGIC ||
+        header->version != 1 || header->count < 0 || header->count > MAX_STUDENTS || header->through_day < 0 ||
+        fread(gate_outside, sizeof(GateOutside), header->count, fp) != (size_t)header->count) {
+        gate_outside_count = 0;
+        return 0;
+    }
+    for (int i = 0; i < header->count; i++) {
+        gate_outside[i].hostel_block[sizeof(gate_outside[i].hostel_block) - 1] = '\0';
+        if (i > 0 && gate_outside[i - 1].student_id >= gate_outside[i].student_id) {
+            gate_outside_count = 0;
+            return 0;
+        }
+    }
+    gate_outside_count = header->count;
+    return 1;
+}
+
+/* STARTUP: THE OUTSIDE SET COMES FROM gate_outside.dat AND ONLY EVENTS LOGGED AFTER IT WAS
+   WRITTEN ARE APPLIED (NONE, UNLESS THE PROGRAM STOPPED BETWEEN THE TWO WRITES). WITHOUT A
+   USABLE gate_outside.dat THE LAST GATE_REBUILD_DAYS OF THE LOG ARE REPLAYED. A SEGMENT LEFT
+   HALF WRITTEN AT THE END OF A FILE IS CUT OFF */
+void gate_load() {
+    static GateEvent events[GATE_BATCH_EVENTS];
+    GateOutsideHeader header;
+    int today = gate_day((unsigned int)time(NULL) + GATE_CLOCK_SLACK);
+    int from_day, changed = 0;
+    unsigned int from_offset = 0;
+    FILE *fp;
+
+    gate_flush();
+    gate_batch_count = 0;
+    gate_last_event = 0;
+    gate_tail_day = -1;
+    gate_tail_offset = 0;
+
+    fp = fopen(GATE_OUTSIDE_FILE, "rb");
+    if (fp != NULL && gate_read_outside(fp, &header)) {
+        from_day = header.through_day < today ? header.through_day : today;
+        from_offset = header.through_offset;
+        gate_last_event = header.last_event;
+    } else {
+        from_day = today - GATE_REBUILD_DAYS;
+        changed = fp != NULL;           // A DAMAGED FILE IS REPLACED EVEN IF THE LOG IS EMPTY
+    }
+    if (fp != NULL) fclose(fp);
+
+    for (int day = from_day; day <= today; day++) {
+        GateSegmentHeader segment;
+        char path[64];
+        long valid_end, size;
+
+        gate_file_name(path, sizeof(path), day);
+        fp = fopen(path, "rb");
+        if (fp == NULL) continue;
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        /* AN OFFSET BEYOND THE END MEANS THE FILE WAS REPLACED: READ IT ALL (SEE gate_set_apply) */
+        valid_end = day == from_day && (long)from_offset <= size ? (long)from_offset : 0;
+        fseek(fp, valid_end, SEEK_SET);
+        while (gate_read_header(fp, &segment) && gate_read_events(fp, &segment, events)) {
+            for (int i = 0; i < segment.event_count; i++) {
+                gate_set_apply(gate_outside, &gate_outside_count, MAX_STUDENTS, &events[i]);
+                if (events[i].at > gate_last_event) gate_last_event = events[i].at;
+            }
+            valid_end = ftell(fp);
+            changed = 1;
+        }
+        fclose(fp);
+
+        if (size > valid_end) {
+            if (size - valid_end < (long)(sizeof(GateSegmentHeader) + GATE_BATCH_EVENTS * sizeof(GateEvent))) {
+                gate_cut_file(path, valid_end);
+                changed = 1;
+            } else {
+                printf("\nWARNING: GATE LOG %s IS DAMAGED AFTER BYTE %ld. LATER EVENTS OF THAT DAY ARE SKIPPED.\n",
+                       path, valid_end);
+            }
+        }
+        gate_tail_day = day;
+        gate_tail_offset = (unsigned int)valid_end;
+    }
+    if (changed) gate_write_outside();
+}
+
+/* ---------------------- INPUT HELPERS ---------------------- */
+
+void clear_input_buffer() {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+/* AN OVERLONG LINE IS CUT TO FIT AND ITS REST DISCARDED, SO IT CANNOT SPILL INTO
+   THE NEXT PROMPT. AT END OF INPUT THE BUFFER IS LEFT EMPTY. */
+void read_string(char *prompt, char *buffer, int size) {
+    size_t len;
+    printf("%s", prompt);
+    if (fgets(buffer, size, stdin) == NULL) {
+        buffer[0] = '\0';
+        return;
+    }
+    /* REMOVE NEWLINE */
+    len = strlen(buffer);
+    if (len > 0 && buffer[len - 1] == '\n') {
+        buffer[len - 1] = '\0';
+    } else if (len == (size_t)size - 1) {
+        clear_input_buffer();
+    }
+}
+
+/* READS A WHOLE LINE AND ACCEPTS IT ONLY IF IT IS ONE INTEGER IN int RANGE.
+   AT END OF INPUT IT RETURNS 0, WHICH EVERY MENU TREATS AS BACK / EXIT. */
+int read_int(char *prompt) {
+    char line[64];
+    printf("%s", prompt);
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *end;
+        long value;
+        size_t len = strlen(line);
+
+        if (len > 0 && line[len - 1] != '\n' && !feof(stdin)) {
+            clear_input_buffer();
+        } else {
+            errno = 0;
+            value = strtol(line, &end, 10);
+            while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') end++;
+            if (end != line && *end == '\0' && errno == 0 && value >= INT_MIN && value <= INT_MAX) {
+                return (int)value;
+            }
+        }
+        printf("INVALID INPUT. ENTER INTEGER VALUE: ");
+    }
+    return 0;
+}
+
+/* ---------------------- SELF CHECKS ---------------------- */
+
+/* RETURNS NULL WHEN THE IN-MEMORY STORES AND EVERYTHING DERIVED FROM THEM AGREE,
+   OTHERWISE A SHORT DESCRIPTION OF THE FIRST PROBLEM FOUND */
+const char *check_store_invariants() {
+    int occupied = 0, housed = 0;
+    const char *problem;
+
+    if (student_count < 0 || student_count > MAX_STUDENTS) return "STUDENT COUNT OUT OF RANGE";
+    if (ticket_count < 0 || ticket_count > MAX_TICKETS) return "TICKET COUNT OUT OF RANGE";
+    if (room_count < 0 || room_count > MAX_ROOMS) return "ROOM COUNT OUT OF RANGE";
+
+    /* INDEXES THAT CLAIM TO BE UP TO DATE MUST MATCH THE STORES EXACTLY */
+    ensure_record_indexes();
+    problem = validate_record_indexes();
+    if (problem != NULL) return problem;
+
+    for (int i = 0; i < student_count; i++) {
+        for (size_t f = 0; f < sizeof(student_text_fields) / sizeof(TextField); f++) {
+            if (memchr((char *)&students[i] + student_text_fields[f].offset, '\0', student_text_fields[f].size) == NULL) {
+                return "UNTERMINATED STUDENT TEXT FIELD";
+            }
+        }
+        if (students[i].is_active != 0 && students[i].is_active != 1) return "BAD ACTIVE FLAG";
+        if (find_student_by_id(students[i].id) != i) return "DUPLICATE STUDENT ID";
+    }
+
+    for (int i = 0; i < ticket_count; i++) {
+        for (size_t f = 0; f < sizeof(ticket_text_fields) / sizeof(TextField); f++) {
+            if (memchr((char *)&tickets[i] + ticket_text_fields[f].offset, '\0', ticket_text_fields[f].size) == NULL) {
+                return "UNTERMINATED TICKET TEXT FIELD";
+            }
+        }
+        if (strcmp(tickets[i].status, ticket_status_name(ticket_status_code(tickets[i].status))) != 0) {
+            return "UNKNOWN TICKET STATUS";
+        }
+        if (find_ticket_by_id(tickets[i].ticket_id) != i) return "DUPLICATE TICKET ID";
+        if (tickets[i].ticket_id >= next_ticket_id && tickets[i].ticket_id < INT_MAX - MAX_TICKETS) {
+            return "NEXT TICKET ID ALREADY USED";
+        }
+    }
+
+    for (int b = 0; b < block_count; b++) {
+        int free_beds = 0;
+        for (int r = 0; r < room_count; r++) {
+            unsigned int full = room_full_mask(rooms[r].capacity);
+            int vacant = (blocks[b].vacancy[r / 32] >> (r % 32)) & 1u;
+            if (room_block[r] != b) {
+                if (vacant) return "VACANCY BIT IN WRONG BLOCK";
+                continue;
+            }
+            if (room_bed_mask[r] & ~full) return "BED BIT BEYOND CAPACITY";
+            if (vacant != (room_bed_mask[r] != full)) return "VACANCY BIT OUT OF DATE";
+            free_beds += rooms[r].capacity - count_set_bits(room_bed_mask[r]);
+        }
+        if (free_beds != blocks[b].free_beds) return "BLOCK FREE BED COUNT OUT OF DATE";
+    }
+
+    for (int r = 0; r < room_count; r++) {
+        if (rooms[r].capacity < 1 || rooms[r].capacity > MAX_BEDS_PER_ROOM) return "BAD ROOM CAPACITY";
+        if (find_room(rooms[r].hostel_block, rooms[r].room_no) != r) return "DUPLICATE ROOM";
+        for (int bed = 0; bed < rooms[r].capacity; bed++) {
+            int index;
+            if (!((room_bed_mask[r] >> bed) & 1u)) continue;
+            index = find_student_by_id(room_bed_student[r][bed]);
+            if (index == -1 || !students[index].is_active ||
+                strcmp(students[index].room_no, rooms[r].room_no) != 0 ||
+                strcmp(students[index].hostel_block, rooms[r].hostel_block) != 0) {
+                return "BED HELD FOR A STUDENT NOT IN THAT ROOM";
+            }
+            occupied++;
+        }
+    }
+    for (int i = 0; i < student_count; i++) {
+        if (students[i].is_active && students[i].room_no[0] != '\0' &&
+            find_room(students[i].hostel_block, students[i].room_no) != -1) {
+            housed++;
+        }
+    }
+    if (housed != occupied + room_overbooked) return "STUDENTS AND OCCUPIED BEDS DISAGREE";
+
+    /* THE SHARD INDEX (IF IT SAYS IT IS UP TO DATE) LISTS EVERY RECORD ONCE, UNDER ITS OWN KEY */
+    rebuild_shard_index();
+    {
+        int listed_students = 0, listed_tickets = 0;
+        char key[SHARD_KEY_SIZE];
+        for (int s = 0; s < shard_count; s++) {
+            for (int k = 0; k < shards[s].student_count; k++) {
+                shard_key(students[shard_student_pos[shards[s].first_student + k]].hostel_block, key);
+                if (strcmp(key, shards[s].key) != 0 && s != MAX_SHARDS - 1) return "STUDENT IN WRONG SHARD";
+            }
+            for (int k = 0; k < shards[s].ticket_count; k++) {
+                shard_key(tickets[shard_ticket_pos[shards[s].first_ticket + k]].hostel_block, key);
+                if (strcmp(key, shards[s].key) != 0 && s != MAX_SHARDS - 1) return "TICKET IN WRONG SHARD";
+            }
+            listed_students += shards[s].student_count;
+            listed_tickets += shards[s].ticket_count;
+        }
+        if (listed_students != student_count || listed_tickets != ticket_count) return "SHARD INDEX OUT OF DATE";
+    }
+
+    return check_sla_matches_rebuild();
+}
+
+/* THE INCREMENTALLY MAINTAINED SLA NUMBERS MUST EQUAL A FRESH REBUILD */
+const char *check_sla_matches_rebuild() {
+    static SlaBlockStats kept_blocks[MAX_BLOCKS + 1];
+    int kept_count = sla_block_count, kept_older = sla_open_older, kept_untracked = sla_untracked;
+    int kept_open = 0, open = 0, late = 0;
+    unsigned int now = (unsigned int)time(NULL);
+    int kept_breaching = scan_breaching_tickets(now, 0);
+
+    for (int slot = 0; slot < SLA_DAY_SLOTS; slot++) kept_open += sla_open_day_count[slot];
+    memcpy(kept_blocks, sla_blocks, sizeof(sla_blocks));
+
+    rebuild_sla_stats();
+
+    for (int slot = 0; slot < SLA_DAY_SLOTS; slot++) open += sla_open_day_count[slot];
+    if (kept_open + kept_older != open + sla_open_older) return "OPEN TICKET AGE COUNTS OUT OF DATE";
+    if (kept_untracked != sla_untracked) return "UNTRACKED TICKET COUNT OUT OF DATE";
+    for (int i = 0; i < ticket_count; i++) {
+        Ticket *t = &tickets[i];
+        if (t->created_at != 0 && t->created_at < now && now - t->created_at > SLA_BREACH_HOURS * 3600u &&
+            ticket_status_code(t->status) != TICKET_RESOLVED) {
+            late++;
+        }
+    }
+    if (kept_breaching != late) return "SLA BREACH COUNT DOES NOT MATCH THE OPEN TICKETS";
+
+    /* WHICH BLOCKS LAND IN THE OTHER ROW DEPENDS ON THE ORDER THEY WERE SEEN, SO ONCE IT IS
+       IN USE ONLY THE TOTALS OVER ALL ROWS HAVE TO AGREE */
+    if (kept_count > MAX_BLOCKS || sla_block_count > MAX_BLOCKS) {
+        SlaBlockStats kept_sum, fresh_sum;
+        memset(&kept_sum, 0, sizeof(kept_sum));
+        memset(&fresh_sum, 0, sizeof(fresh_sum));
+        for (int pass = 0; pass < 2; pass++) {
+            SlaBlockStats *rows = pass == 0 ? kept_blocks : sla_blocks, *sum = pass == 0 ? &kept_sum : &fresh_sum;
+            for (int b = 0; b < (pass == 0 ? kept_count : sla_block_count); b++) {
+                sum->open += rows[b].open;
+                sum->resolved += rows[b].resolved;
+                sum->resolved_late += rows[b].resolved_late;
+                sum->total_resolve_secs += rows[b].total_resolve_secs;
+                for (int h = 0; h < SLA_RES_BUCKETS; h++) sum->resolve_hist[h] += rows[b].resolve_hist[h];
+            }
+        }
+        return memcmp(&kept_sum, &fresh_sum, sizeof(SlaBlockStats)) != 0 ? "SLA BLOCK STATS OUT OF DATE" : NULL;
+    }
+
+    for (int b = 0; b < kept_count; b++) {
+        SlaBlockStats *fresh = NULL;
+        for (int f = 0; f < sla_block_count; f++) {
+            if (strcmp(sla_blocks[f].name, kept_blocks[b].name) == 0) fresh = &sla_blocks[f];
+        }
+        if (fresh == NULL) {
+            /* A BLOCK WHOSE TICKETS ALL LEFT MUST BE BACK TO ZERO */
+            if (kept_blocks[b].open != 0 || kept_blocks[b].resolved != 0) return "SLA BLOCK NOT EMPTIED";
+            continue;
+        }
+        if (fresh->open != kept_blocks[b].open || fresh->resolved != kept_blocks[b].resolved ||
+            fresh->resolved_late != kept_blocks[b].resolved_late ||
+            fresh->total_resolve_secs != kept_blocks[b].total_resolve_secs ||
+            memcmp(fresh->resolve_hist, kept_blocks[b].resolve_hist, sizeof(fresh->resolve_hist)) != 0) {
+            return "SLA BLOCK STATS OUT OF DATE";
+        }
+    }
+    return NULL;
+}
+
+/* ---------------------- FUZZ TARGET (BUILD WITH -DHMS_FUZZ) ---------------------- */
+
+#ifdef HMS_FUZZ
+#include <stdint.h>
+
+/* FIRST BYTE PICKS THE TARGET, THE REST IS THE FILE CONTENT, COMPRESSED BLOCK OR CONSOLE INPUT */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const char *problem;
+    FILE *fp;
+    int target;
+
+    if (size < 1) return 0;
+    target = data[0] % 16 == 8 ? 8 : data[0] % 8;
+
+    if (target == 3) {
+        /* ARCHIVE BLOCKS: DAMAGED INPUT MUST BE REJECTED, AND RAW INPUT MUST ROUND TRIP */
+        static unsigned char unpacked[ARCHIVE_BLOCK_RECORDS * sizeof(Student)];
+        static unsigned char packed[ARCHIVE_BLOCK_RECORDS * sizeof(Student) * 2];
+        int n = size - 1 > sizeof(unpacked) ? (int)sizeof(unpacked) : (int)(size - 1);
+        int len;
+
+        lz_decompress(data + 1, (int)(size - 1), unpacked, (int)sizeof(unpacked));
+        len = lz_compress(data + 1, n, packed);
+        if (lz_decompress(packed, len, unpacked, (int)sizeof(unpacked)) != n ||
+            memcmp(unpacked, data + 1, n) != 0) {
+            fprintf(stderr, "LZ ROUND TRIP FAILED\n");
+            abort();
+        }
+        return 0;
+    }
+
+    fp = tmpfile();
+    if (fp == NULL) return 0;
+    fwrite(data + 1, 1, size - 1, fp);
+    rewind(fp);
+
+    student_count = 0;
+    ticket_count = 0;
+    room_count = 0;
+    next_ticket_id = 1;
+    switch (target) {
+        case 0: load_students(fp); break;
+        case 1: load_tickets(fp); break;
+        case 2: load_rooms(fp); break;
+        case 4: {
+            /* shards.dat: EVERY KEY THAT SURVIVES MUST BE SAFE AS A FILE NAME PART */
+            static char keys[MAX_SHARDS][SHARD_KEY_SIZE];
+            ShardFileHeader header;
+            if (read_shard_manifest(fp, &header, keys)) {
+                for (int s = 0; s < header.shard_count; s++) {
+                    char key[SHARD_KEY_SIZE];
+                    if (keys[s][0] == '\0') continue;
+                    shard_key(keys[s], key);
+                    if (strcmp(key, keys[s]) != 0) {
+                        fprintf(stderr, "UNSAFE SHARD KEY ACCEPTED\n");
+                        abort();
+                    }
+                }
+            }
+            break;
+        }
+        case 5: {
+            /* GATE DAY FILE: EVERY SEGMENT ACCEPTED MUST KEEP ITS EVENTS IN ORDER AND IN RANGE */
+            static GateEvent events[GATE_BATCH_EVENTS];
+            GateSegmentHeader header;
+            gate_outside_count = 0;
+            while (gate_read_header(fp, &header) && gate_read_events(fp, &header, events)) {
+                for (int i = 0; i < header.event_count; i++) {
+                    if (events[i].at < header.min_time || events[i].at > header.max_time ||
+                        memchr(events[i].hostel_block, '\0', sizeof(events[i].hostel_block)) == NULL) {
+                        fprintf(stderr, "BAD GATE EVENT ACCEPTED\n");
+                        abort();
+                    }
+                    gate_set_apply(gate_outside, &gate_outside_count, MAX_STUDENTS, &events[i]);
+                }
+            }
+            for (int i = 1; i < gate_outside_count; i++) {
+                if (gate_outside[i - 1].student_id >= gate_outside[i].student_id) {
+                    fprintf(stderr, "OUTSIDE SET OUT OF ORDER\n");
+                    abort();
+                }
+            }
+            break;
+        }
+        case 6:
+        case 7: {
+            /* STUDENT CSV / JSONL IMPORT INTO AN EMPTY STORE */
+            ImportTally tally;
+            memset(&tally, 0, sizeof(tally));
+            note_records_moved();
+            import_students(fp, target == 7, &tally);
+            break;
+        }
+        case 8: {
+            /* CONSOLE INPUT: THE PROMPT HELPERS READ THE FUZZ DATA AS THEIR STANDARD INPUT */
+            static const int sizes[] = { 1, 2, 8, 50 };
+            const char *text = (const char *)data + 1;
+            FILE *console = stdin;
+            stdin = fp;
+            for (int round = 0; round < 64 && !feof(stdin); round++) {
+                if (round % 2 == 0) {
+                    int value = read_int("");
+                    long end = ftell(stdin), start;
+                    char line[64];
+                    if (value == 0 || end <= 0) continue;
+                    /* THE LAST LINE READ WAS THE ONE ACCEPTED, AND IT MUST HOLD THAT NUMBER */
+                    if (text[end - 1] == '\n') end--;
+                    for (start = end; start > 0 && text[start - 1] != '\n'; start--) {}
+                    if (end - start >= (long)sizeof(line)) {
+                        fprintf(stderr, "OVERLONG NUMBER LINE ACCEPTED\n");
+                        abort();
+                    }
+                    memcpy(line, text + start, end - start);
+                    line[end - start] = '\0';
+                    if (strtol(line, NULL, 10) != value) {
+                        fprintf(stderr, "read_int RETURNED A NUMBER NOT ON THE LINE\n");
+                        abort();
+                    }
+                } else {
+                    int n = sizes[(round / 2) % 4];
+                    char *buffer = malloc(n);      // EXACT SIZE, SO AN OVERRUN IS CAUGHT
+                    if (buffer == NULL) break;
+                    read_string("", buffer, n);
+                    if (memchr(buffer, '\0', n) == NULL || strchr(buffer, '\n') != NULL) {
+                        fprintf(stderr, "read_string LEFT A BAD BUFFER\n");
+                        abort();
+                    }
+                    free(buffer);
+                }
+            }
+            if (feof(stdin)) {
+                char buffer[8];
+                read_string("", buffer, sizeof(buffer));
+                if (read_int("") != 0 || buffer[0] != '\0') {
+                    fprintf(stderr, "INPUT HELPERS RETURNED DATA AFTER END OF INPUT\n");
+                    abort();
+                }
+            }
+            stdin = console;
+            break;
+        }
+    }
+    fclose(fp);
+    finish_load();
+
+    problem = check_store_invariants();
+    if (problem != NULL) {
+        fprintf(stderr, "INVARIANT BROKEN AFTER LOAD: %s\n", problem);
+        abort();
+    }
+    return 0;
+}
+
+#ifdef HMS_FUZZ_MAIN
+/* STANDALONE DRIVER FOR AFL AND FOR REPLAYING A SAVED CRASH: ONE INPUT FILE PER
+   ARGUMENT, OR STANDARD INPUT WHEN THERE ARE NONE */
+int main(int argc, char **argv) {
+    static unsigned char buffer[1 << 20];
+    for (int i = 1; i < argc || i == 1; i++) {
+        FILE *fp = argc > 1 ? fopen(argv[i], "rb") : stdin;
+        size_t size;
+        if (fp == NULL) continue;
+        size = fread(buffer, 1, sizeof(buffer), fp);
+        if (fp != stdin) fclose(fp);
+        LLVMFuzzerTestOneInput(buffer, size);
+    }
+    return 0;
+}
+#endif
+#endif
+
+/* ---------------------- PROPERTY TESTS (BUILD WITH -DHMS_SELFTEST) ---------------------- */
+
+#ifdef HMS_SELFTEST
+
+unsigned int test_rng_state;
+
+unsigned int test_rand(unsigned int limit) {
+    /* XORSHIFT32, SAME SEQUENCE ON EVERY PLATFORM FOR A GIVEN SEED */
+    test_rng_state ^= test_rng_state << 13;
+    test_rng_state ^= test_rng_state >> 17;
+    test_rng_state ^= test_rng_state << 5;
+    return limit == 0 ? 0 : test_rng_state % limit;
+}
+
+void test_random_text(char *buffer, int size, const char *const *words, int word_count) {
+    snprintf(buffer, size, "%s", words[test_rand(word_count)]);
+}
+
+/* EVERY PAGE OF A FRESH SNAPSHOT MUST HOLD EXACTLY THE LIVE RECORDS */
+const char *check_generation_matches_live(Snapshot *snap) {
+    if (snap->student_count != student_count || snap->ticket_count != ticket_count) {
+        return "SNAPSHOT COUNTS DIFFER FROM LIVE STORES";
+    }
+    for (int p = 0; p < snap->student_page_count; p++) {
+        if (memcmp(snap->student_pages[p]->data, &students[p * PAGE_RECORDS],
+                   snap->student_pages[p]->records * sizeof(Student)) != 0) {
+            return "SNAPSHOT STUDENT PAGE DIFFERS FROM LIVE STORE";
+        }
+    }
+    for (int p = 0; p < snap->ticket_page_count; p++) {
+        if (memcmp(snap->ticket_pages[p]->data, &tickets[p * PAGE_RECORDS],
+                   snap->ticket_pages[p]->records * sizeof(Ticket)) != 0) {
+            return "SNAPSHOT TICKET PAGE DIFFERS FROM LIVE STORE";
+        }
+    }
+    return NULL;
+}
+
+/* SAVE, THROW AWAY THE STORES, LOAD AGAIN: EVERY RECORD MUST COME BACK BYTE FOR BYTE */
+const char *check_reload_equivalence() {
+    static Student saved_students[MAX_STUDENTS];
+    static Ticket saved_tickets[MAX_TICKETS];
+    static Room saved_rooms[MAX_ROOMS];
+    static GateOutside saved_outside[MAX_STUDENTS];
+    int saved_student_count = student_count, saved_ticket_count = ticket_count;
+    int saved_room_count = room_count, saved_next_id = next_ticket_id;
+    int saved_outside_count = gate_outside_count;
+
+    memcpy(saved_outside, gate_outside, sizeof(gate_outside));
+    memcpy(saved_students, students, sizeof(students));
+    memcpy(saved_tickets, tickets, sizeof(tickets));
+    memcpy(saved_rooms, rooms, sizeof(rooms));
+
+    save_data();
+    memset(students, 0xAB, sizeof(students));
+    memset(tickets, 0xAB, sizeof(tickets));
+    memset(rooms, 0xAB, sizeof(rooms));
+    load_data();
+
+    if (student_count != saved_student_count || ticket_count != saved_ticket_count ||
+        room_count != saved_room_count || next_ticket_id != saved_next_id) {
+        return "COUNTS CHANGED ACROSS SAVE AND LOAD";
+    }
+    if (memcmp(students, saved_students, student_count * sizeof(Student)) != 0) return "STUDENTS CHANGED ACROSS SAVE AND LOAD";
+    if (memcmp(tickets, saved_tickets, ticket_count * sizeof(Ticket)) != 0) return "TICKETS CHANGED ACROSS SAVE AND LOAD";
+    if (memcmp(rooms, saved_rooms, room_count * sizeof(Room)) != 0) return "ROOMS CHANGED ACROSS SAVE AND LOAD";
+    if (gate_outside_count != saved_outside_count ||
+        memcmp(gate_outside, saved_outside, gate_outside_count * sizeof(GateOutside)) != 0) {
+        return "OUTSIDE SET CHANGED ACROSS SAVE AND LOAD";
+    }
+    return NULL;
+}
+
+/* THE NAME INDEX MUST FIND EXACTLY THE STUDENTS A PLAIN strstr() SCAN FINDS */
+const char *check_name_search(const char *text) {
+    int *matches = malloc(student_count * sizeof(int) + 1);
+    unsigned char *found = calloc(student_count + 1, 1);
+    const char *problem = NULL;
+    int count, expected = 0;
+
+    if (matches == NULL || found == NULL) {
+        free(matches);
+        free(found);
+        return NULL;
+    }
+    ensure_record_indexes();
+    count = find_name_matches(text, matches);
+    for (int k = 0; k < count && problem == NULL; k++) {
+        if (found[matches[k]]++) problem = "NAME SEARCH LISTED A STUDENT TWICE";
+    }
+    for (int i = 0; i < student_count && problem == NULL; i++) {
+        int contains = strstr(students[i].name, text) != NULL;
+        expected += contains;
+        if (contains != found[i]) problem = "NAME SEARCH RESULT DIFFERS FROM A SCAN";
+    }
+    if (problem == NULL && count != expected) problem = "NAME SEARCH COUNT WRONG";
+    free(matches);
+    free(found);
+    return problem;
+}
+
+/* EXPORT EVERY COLUMN AND IMPORT IT OVER THE SAME STUDENTS: NOTHING MAY CHANGE. THEN
+   IMPORT IT INTO AN EMPTY STORE: EVERY STUDENT MUST COME BACK FIELD FOR FIELD */
+const char *check_export_round_trip(int jsonl) {
+    static Student before[MAX_STUDENTS];
+    int columns[STUDENT_COLUMNS], column_count = parse_column_list("", columns);
+    int count = student_count, saved_room_count = room_count;
+    const char *problem = NULL;
+    ImportTally tally;
+    FILE *fp = tmpfile();
+
+    if (fp == NULL) return NULL;
+    memcpy(before, students, count * sizeof(Student));
+    if (write_student_export(fp, jsonl, columns, column_count) != count) problem = "EXPORT DID NOT WRITE EVERY STUDENT";
+
+    memset(&tally, 0, sizeof(tally));
+    rewind(fp);
+    import_students(fp, jsonl, &tally);
+    if (problem == NULL && (tally.unchanged != count || memcmp(students, before, count * sizeof(Student)) != 0)) {
+        problem = "IMPORTING AN EXPORT CHANGED THE STUDENTS";
+    }
+
+    /* A ROW THAT ONLY FLIPS is_active OFF AND THEN ON AGAIN: THE BED IS FREED AND TAKEN BACK.
+       A STUDENT HOLDING A ROOM THAT IS NOT IN THE INVENTORY WOULD RIGHTLY BE REFUSED THE SECOND TIME */
+    for (int i = 0; i < count && problem == NULL; i++) {
+        if (!students[i].is_active ||
+            (students[i].room_no[0] != '\0' && find_room(students[i].hostel_block, students[i].room_no) == -1)) continue;
+        for (int active = 0; active <= 1 && problem == NULL; active++) {
+            FILE *row = tmpfile();
+            if (row == NULL) break;
+            fprintf(row, jsonl ? "{\"id\":%d,\"is_active\":%d}\n" : "id,is_active\n%d,%d\n", students[i].id, active);
+            rewind(row);
+            memset(&tally, 0, sizeof(tally));
+            import_students(row, jsonl, &tally);
+            fclose(row);
+            if (tally.updated != 1 || students[i].is_active != active) problem = "IMPORT DID NOT APPLY A CHANGED is_active";
+        }
+        if (problem == NULL && memcmp(&students[i], &before[i], sizeof(Student)) != 0) {
+            problem = "DEACTIVATING AND REACTIVATING BY IMPORT CHANGED THE STUDENT";
+        }
+        break;
+    }
+
+    /* NO INVENTORY WHILE IMPORTING, SO EVERY ROOM IS TAKEN AS IT IS; BEDS ARE GIVEN OUT AGAIN AFTER */
+    student_count = 0;
+    room_count = 0;
+    note_records_moved();
+    memset(&tally, 0, sizeof(tally));
+    rewind(fp);
+    import_students(fp, jsonl, &tally);
+    room_count = saved_room_count;
+    rebuild_room_occupancy();
+    mark_all_dirty();
+    fclose(fp);
+
+    if (problem == NULL && (student_count != count || tally.added != count)) problem = "IMPORT INTO AN EMPTY STORE LOST STUDENTS";
+    for (int i = 0; i < student_count && problem == NULL; i++) {
+        if (students[i].id != before[i].id || students[i].is_active != before[i].is_active) {
+            problem = "ID OR ACTIVE FLAG CHANGED BY EXPORT AND IMPORT";
+        }
+        for (int f = 0; f < STUDENT_FIELD_COUNT && problem == NULL; f++) {
+            if (strcmp(student_text(&students[i], &student_fields[f]), student_text(&before[i], &student_fields[f])) != 0) {
+                problem = "TEXT FIELD CHANGED BY EXPORT AND IMPORT";
+            }
+        }
+    }
+    return problem;
+}
+
+/* REPLAYING THE GATE LOG FROM THE START MUST GIVE THE INCREMENTALLY KEPT OUTSIDE SET */
+GateOutside replayed_outside[MAX_STUDENTS];
+int replayed_outside_count;
+
+void replay_gate_event(const GateEvent *e, void *unused) {
+    (void)unused;
+    gate_set_apply(replayed_outside, &replayed_outside_count, MAX_STUDENTS, e);
+}
+
+const char *check_gate_matches_replay(unsigned int since) {
+    replayed_outside_count = 0;
+    gate_scan(since, (unsigned int)time(NULL) + GATE_CLOCK_SLACK + 1, 0, replay_gate_event, NULL);
+    if (replayed_outside_count != gate_outside_count ||
+        memcmp(replayed_outside, gate_outside, gate_outside_count * sizeof(GateOutside)) != 0) {
+        return "OUTSIDE SET DIFFERS FROM A REPLAY OF THE GATE LOG";
+    }
+    return NULL;
+}
+
+/* A SAVE CUT SHORT IN THE MIDDLE OF A SEGMENT: A HEADER PROMISING MORE EVENTS THAN FOLLOW IT */
+void tear_gate_log() {
+    GateSegmentHeader header;
+    GateEvent events[3];
+    char path[64];
+    FILE *fp;
+
+    if (gate_tail_day < 0) return;
+    memset(&header, 0, sizeof(header));
+    memset(events, 0, sizeof(events));
+    header.magic = GATE_MAGIC;
+    header.event_count = 10;
+    header.min_time = header.max_time = gate_last_event;
+    gate_file_name(path, sizeof(path), gate_tail_day);
+    fp = fopen(path, "ab");
+    if (fp == NULL) return;
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(events, sizeof(GateEvent), 3, fp);
+    fclose(fp);
+}
+
+void remove_gate_files(unsigned int since) {
+    char path[64];
+    for (int day = gate_day(since); day <= gate_day((unsigned int)time(NULL) + GATE_CLOCK_SLACK); day++) {
+        gate_file_name(path, sizeof(path), day);
+        remove(path);
+    }
+    remove(GATE_OUTSIDE_FILE);
+}
+
+/* RANDOM OPERATION SEQUENCES AGAINST THE STORES, WITH ALL INVARIANTS CHECKED AFTER EACH */
+int run_property_tests(unsigned int seed, int operations) {
+    static const char *const names[] = { "ARUN", "BALA", "CHITRA", "DEEPA", "ESWAR", "FARHAN", "GOKUL", "HARINI" };
+    static const char *const block_names[] = { "A", "B", "C", "D", "" };
+    static const char *const room_names[] = { "101", "102", "103", "201", "202", "", "999" };
+    static const char *const awkward_text[] = { "A,B", "SAY \"HI\"", "TWO\nLINES", "CR\r\nLF", " SPACED ",
+                                               "BACK\\SLASH", "\x01\x1F\t", "\xC3\xA9\xFF" };
+    static const char *const op_names[] = { "ADD STUDENT", "UPDATE STUDENT", "MOVE ROOM", "DELETE STUDENT",
+                                            "RAISE ISSUE", "SET STATUS", "SORT", "ADD ROOM", "BULK ALLOCATE",
+                                            "TAKE SNAPSHOT", "RESTORE SNAPSHOT", "SAVE AND RELOAD", "GATE SCANS",
+                                            "CSV / JSONL ROUND TRIP", "NAME SEARCH" };
+    const char *problem = NULL;
+    unsigned int gate_start = (unsigned int)time(NULL) - 20 * SECONDS_PER_DAY, gate_clock = gate_start;
+    FILE *existing = fopen(STUDENT_FILE, "rb");
+
+    if (existing == NULL) existing = fopen(SHARD_FILE, "rb");
+    if (existing == NULL) existing = fopen(GATE_OUTSIDE_FILE, "rb");
+    if (existing != NULL) {
+        fclose(existing);
+        printf("REFUSING TO RUN: DATA FILES EXIST. RUN THE SELF TEST IN AN EMPTY FOLDER.\n");
+        return 2;
+    }
+
+    test_rng_state = seed != 0 ? seed : 1;
+    load_data();
+
+    for (int step = 1; step <= operations && problem == NULL; step++) {
+        int op = (int)test_rand(112);
+        /* WEIGHTS: MOSTLY EDITS, OCCASIONAL SNAPSHOTS, GATE BURSTS AND ROUND TRIPS, RARE RELOADS */
+        op = op < 18 ? 0 : op < 28 ? 1 : op < 36 ? 2 : op < 44 ? 3 : op < 60 ? 4 : op < 76 ? 5 :
+             op < 80 ? 6 : op < 86 ? 7 : op < 89 ? 8 : op < 94 ? 9 : op < 98 ? 10 : op < 100 ? 11 :
+             op < 105 ? 12 : op < 108 ? 13 : 14;
+
+        switch (op) {
+            case 0: {
+                Student s;
+                memset(&s, 0, sizeof(Student));
+                s.id = (int)test_rand(300) + 1;
+                if (student_count >= MAX_STUDENTS || find_student_by_id(s.id) != -1) break;
+                test_random_text(s.name, sizeof(s.name), names, 8);
+                test_random_text(s.campus, sizeof(s.campus), block_names, 2);
+                test_random_text(s.hostel_block, sizeof(s.hostel_block), block_names, 5);
+                test_random_text(s.room_no, sizeof(s.room_no), room_names, 7);
+                s.is_active = 1;
+                insert_student(&s);
+                break;
+            }
+            case 1:
+                if (student_count == 0) break;
+                {
+                    int index = (int)test_rand(student_count);
+                    const StudentField *f = &student_fields[test_rand(STUDENT_FIELD_COUNT)];
+                    char text[IMPORT_CELL_SIZE];
+                    if (test_rand(2) == 0) {
+                        test_random_text(text, sizeof(text), names, 8);
+                    } else {
+                        test_random_text(text, sizeof(text), awkward_text, 8);
+                    }
+                    set_student_field(index, f, text);
+                }
+                break;
+            case 2:
+                if (student_count == 0) break;
+                {
+                    char block[10], room[10];
+                    int index = (int)test_rand(student_count);
+                    test_random_text(block, sizeof(block), block_names, 5);
+                    test_random_text(room, sizeof(room), room_names, 7);
+                    move_student_room(index, block, room);
+                    mark_student_dirty(index);
+                }
+                break;
+            case 3:
+                if (student_count > 0) soft_delete_student((int)test_rand(student_count));
+                break;
+            case 4:
+                if (student_count > 0 && ticket_count < MAX_TICKETS) {
+                    Ticket t;
+                    int index = (int)test_rand(student_count);
+                    if (!students[index].is_active) break;
+                    memset(&t, 0, sizeof(Ticket));
+                    snprintf(t.issue, sizeof(t.issue), "ISSUE %u", test_rand(1000));
+                    open_ticket(&t, index);
+                    /* BACKDATE SO THAT AGE BUCKETS AND RESOLUTION TIMES SPREAD OUT; NOW AND THEN A
+                       FREE-TEXT BLOCK, SO THAT MORE THAN MAX_BLOCKS NAMES REACH THE SLA TABLE */
+                    sla_track_open(&tickets[ticket_count - 1], -1);
+                    tickets[ticket_count - 1].created_at -= test_rand(40 * SECONDS_PER_DAY);
+                    if (test_rand(4) == 0) {
+                        snprintf(tickets[ticket_count - 1].hostel_block, sizeof(tickets[0].hostel_block),
+                                 "X%u", test_rand(MAX_BLOCKS + 8));
+                    }
+                    sla_track_open(&tickets[ticket_count - 1], 1);
+                }
+                break;
+            case 5:
+                if (ticket_count > 0) set_ticket_status((int)test_rand(ticket_count), (int)test_rand(3));
+                break;
+            case 6:
+                sort_students((int)test_rand(2));
+                break;
+            case 7: {
+                Room room;
+                int occupants;
+                memset(&room, 0, sizeof(Room));
+                test_random_text(room.hostel_block, sizeof(room.hostel_block), block_names, 4);
+                test_random_text(room.room_no, sizeof(room.room_no), room_names, 5);
+                room.capacity = (int)test_rand(4) + 1;
+                if (room_count < MAX_ROOMS) insert_room(&room, &occupants);
+                break;
+            }
+            case 8: {
+                int moved, waiting;
+                allocate_unassigned_students(&moved, &waiting);
+                break;
+            }
+            case 9:
+                take_snapshot(1);
+                problem = check_generation_matches_live(&snapshots[snapshot_count - 1]);
+                break;
+            case 10:
+                if (snapshot_count > 0) {
+                    Snapshot *snap = &snapshots[test_rand(snapshot_count)];
+                    int next_id = next_ticket_id;
+                    int archived_students, archived_tickets;
+                    restore_generation(snap, &archived_students, &archived_tickets);
+                    if (archived_students == 0 && archived_tickets == 0) problem = check_generation_matches_live(snap);
+                    if (problem == NULL && next_ticket_id < next_id) problem = "RESTORE WENT BACK ON TICKET IDS";
+                }
+                break;
+            case 11:
+                problem = check_reload_equivalence();
+                break;
+            case 12: {
+                /* A BURST OF SCANS, SOMETIMES MORE THAN ONE BATCH AND ACROSS MIDNIGHT; NOW AND THEN
+                   A TORN LAST SEGMENT OR A LOST gate_outside.dat BEFORE A RESTART */
+                unsigned int now = (unsigned int)time(NULL);
+                int burst = (int)test_rand(700) + 1;
+                for (int k = 0; k < burst && student_count > 0; k++) {
+                    gate_clock += test_rand(70);
+                    if (gate_clock > now) gate_clock = now;
+                    gate_record(students[test_rand(student_count)].id, (int)test_rand(2), gate_clock);
+                }
+                switch (test_rand(6)) {
+                    case 0: gate_flush(); tear_gate_log(); gate_load(); break;
+                    case 1: gate_flush(); remove(GATE_OUTSIDE_FILE); gate_load(); break;
+                    case 2: gate_load(); break;
+                }
+                problem = check_gate_matches_replay(gate_start);
+                break;
+            }
+            case 13:
+                problem = check_export_round_trip((int)test_rand(2));
+                break;
+            case 14: {
+                /* SOME PART OF A NAME THAT IS THERE, OR ONE OF THE TEST WORDS */
+                char text[sizeof(students[0].name)];
+                if (student_count > 0 && test_rand(2) == 0) {
+                    const char *name = students[test_rand(student_count)].name;
+                    int length = (int)strlen(name);
+                    int start = length > 0 ? (int)test_rand(length) : 0;
+                    snprintf(text, sizeof(text), "%.*s", (int)test_rand(length - start + 1), name + start);
+                } else {
+                    test_random_text(text, sizeof(text), names, 8);
+                }
+                problem = check_name_search(text);
+                break;
+            }
+        }
+
+        if (problem == NULL) problem = check_store_invariants();
+        if (problem != NULL) {
+            printf("PROPERTY TEST FAILED AT STEP %d (%s), SEED %u: %s\n", step, op_names[op], seed, problem);
+        }
+    }
+
+    remove_shard_files();
+    remove(STUDENT_FILE);
+    remove(TICKET_FILE);
+    remove(ROOM_FILE);
+    remove(TICKET_LOG_FILE);
+    remove_gate_files(gate_start);
+    if (problem != NULL) return 1;
+
+    printf("PROPERTY TEST PASSED: %d OPERATIONS, SEED %u, %d STUDENTS, %d TICKETS, %d ROOMS AT THE END\n",
+           operations, seed, student_count, ticket_count, room_count);
+    return 0;
+}
+
+/* USAGE: hms_selftest [SEED] [OPERATIONS] */
+int main(int argc, char **argv) {
+    unsigned int seed = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : (unsigned int)time(NULL);
+    int operations = argc > 2 ? atoi(argv[2]) : 5000;
+    return run_property_tests(seed, operations);
+}
+#endif
+
+/* ---------------------- STARTUP BENCHMARK (BUILD WITH -DHMS_BENCH) ---------------------- */
+
+#ifdef HMS_BENCH
+
+unsigned int bench_rng_state = 12345;
+
+unsigned int bench_rand(unsigned int limit) {
+    bench_rng_state ^= bench_rng_state << 13;
+    bench_rng_state ^= bench_rng_state >> 17;
+    bench_rng_state ^= bench_rng_state << 5;
+    return bench_rng_state % limit;
+}
+
+/* FILLS THE STORES WITH SHUFFLED STUDENT IDS, THREE WORD NAMES, 16 BLOCKS AND
+   TICKETS RAISED BY RANDOM STUDENTS */
+void bench_fill(int n_students, int n_tickets) {
+    static const char *const words[] = {
+        "ARUN", "PRIYA", "KUMAR", "DEVI", "RAJ", "LAKSHMI", "VIJAY", "MEENA",
+        "SURESH", "ANITHA", "KARTHIK", "DIVYA", "RAMESH", "KAVYA", "GANESH", "SHALINI"
+    };
+    unsigned int now = (unsigned int)time(NULL);
+
+    for (int i = 0; i < n_students; i++) {
+        Student *s = &students[i];
+        memset(s, 0, sizeof(*s));
+        s->id = i + 1;
+        snprintf(s->name, sizeof(s->name), "%s %s %s", words[bench_rand(16)], words[bench_rand(16)],
+                 words[bench_rand(16)]);
+        snprintf(s->hostel_block, sizeof(s->hostel_block), "B%d", i % 16);
+        strcpy(s->fee_status, "PAID");
+        s->is_active = 1;
+    }
+    for (int i = n_students - 1; i > 0; i--) {
+        int j = (int)bench_rand((unsigned int)i + 1), id = students[i].id;
+        students[i].id = students[j].id;
+        students[j].id = id;
+    }
+    student_count = n_students;
+
+    for (int i = 0; i < n_tickets; i++) {
+        Ticket *t = &tickets[i];
+        Student *s = &students[bench_rand((unsigned int)n_students)];
+        memset(t, 0, sizeof(*t));
+        t->ticket_id = i + 1;
+        t->student_id = s->id;
+        strcpy(t->student_name, s->name);
+        strcpy(t->hostel_block, s->hostel_block);
+        strcpy(t->issue, "FAN NOT WORKING");
+        strcpy(t->status, "OPEN");
+        t->created_at = now - bench_rand(30 * 24 * 3600);
+    }
+    ticket_count = n_tickets;
+    next_ticket_id = n_tickets + 1;
+    note_records_moved();
+    rebuild_sla_stats();
+    mark_all_dirty();
+}
+
+/* USAGE: hms_bench [STUDENTS] [TICKETS]. RUN IT IN AN EMPTY FOLDER: IT WRITES AND THEN
+   REMOVES ITS OWN DATA FILES */
+int main(int argc, char **argv) {
+    int n_students = argc > 1 ? atoi(argv[1]) : 1000000;
+    int n_tickets = argc > 2 ? atoi(argv[2]) : 10000000;
+    long long start, saved, indexed, adopted, sorted, rebuilt;
+    IndexLoad index_load;
+    FILE *fp;
+
+    if (n_students < 1) n_students = 1;
+    if (n_students > MAX_STUDENTS) n_students = MAX_STUDENTS;
+    if (n_tickets < 0) n_tickets = 0;
+    if (n_tickets > MAX_TICKETS) n_tickets = MAX_TICKETS;
+    fp = fopen(SHARD_FILE, "rb");
+    if (fp == NULL) fp = fopen(STUDENT_FILE, "rb");
+    if (fp != NULL) {
+        fclose(fp);
+        fprintf(stderr, "DATA FILES FOUND IN THIS FOLDER. RUN THE BENCHMARK IN AN EMPTY FOLDER.\n");
+        return 1;
+    }
+
+    bench_fill(n_students, n_tickets);
+    start = monotonic_ms();
+    save_data();
+    saved = monotonic_ms();
+
+    load_data();
+    find_student_by_id(1);
+    indexed = monotonic_ms();
+
+    /* THE INDEX STEP ON ITS OWN: READ AND CHECK indexes.dat, THEN SORT FROM SCRATCH */
+    memset(&index_load, 0, sizeof(index_load));
+    load_index_file(&index_load);
+    if (!adopt_index_file(&index_load)) printf("WARNING: SAVED INDEXES WERE NOT USED.\n");
+    free(index_load.student_ids);
+    free(index_load.ticket_ids);
+    free(index_load.ticket_owners);
+    free(index_load.gram_start);
+    free(index_load.gram_pos);
+    adopted = monotonic_ms();
+    note_records_moved();
+    ensure_record_indexes();
+    sorted = monotonic_ms();
+
+    remove(INDEX_FILE);
+    load_data();
+    find_student_by_id(1);
+    rebuilt = monotonic_ms();
+
+    printf("STUDENTS: %d, TICKETS: %d, NAME PIECES: %d\n", student_count, ticket_count, name_gram_start[NAME_GRAM_BUCKETS]);
+    printf("SAVE (SHARDS + INDEXES):           %lld MS\n", saved - start);
+    printf("LOAD WITH SAVED INDEXES:           %lld MS\n", indexed - saved);
+    printf("LOAD AND REBUILD THE INDEXES:      %lld MS\n", rebuilt - sorted);
+    printf("INDEXES ONLY, READ FROM FILE:      %lld MS\n", adopted - indexed);
+    printf("INDEXES ONLY, REBUILT:             %lld MS\n", sorted - adopted);
+
+    remove_shard_files();
+    remove(ROOM_FILE);
+    remove(TICKET_LOG_FILE);
+    return 0;
 }
+#endif